@@ -0,0 +1,141 @@
+// Stand-in for bitcoin's arith_uint256
+// Copyright (c) Zawy 2019, MIT License
+/*
+difficulty_jump.cpp was written as if it were inside a node where arith_uint256 exists. This is
+a minimal copy of the same idea (8 little-endian 32-bit limbs, schoolbook multiply, shift-subtract
+divide) so the code compiles and gives the same results without the node's source. It wraps
+mod 2^256 exactly like the real one. It is slow on purpose: it does what bitcoin does.
+*/
+#ifndef ARITH_UINT256_H
+#define ARITH_UINT256_H
+
+#include <cstdint>
+#include <string>
+
+class arith_uint256 {
+public:
+	static const int WIDTH = 8;
+	uint32_t pn[WIDTH];
+
+	arith_uint256(uint64_t b = 0) {
+		pn[0] = (uint32_t)b;
+		pn[1] = (uint32_t)(b >> 32);
+		for (int i = 2; i < WIDTH; i++) { pn[i] = 0; }
+	}
+	arith_uint256 operator~() const { arith_uint256 r; for (int i = 0; i < WIDTH; i++) { r.pn[i] = ~pn[i]; } return r; }
+	arith_uint256 operator-() const { arith_uint256 r = ~(*this); r += 1; return r; }
+
+	arith_uint256& operator+=(const arith_uint256& b) {
+		uint64_t carry = 0;
+		for (int i = 0; i < WIDTH; i++) {
+			uint64_t n = carry + pn[i] + b.pn[i];
+			pn[i] = n & 0xffffffff;
+			carry = n >> 32;
+		}
+		return *this;
+	}
+	arith_uint256& operator-=(const arith_uint256& b) { *this += -b; return *this; }
+
+	arith_uint256& operator*=(const arith_uint256& b) {
+		arith_uint256 a;
+		for (int j = 0; j < WIDTH; j++) {
+			uint64_t carry = 0;
+			for (int i = 0; i + j < WIDTH; i++) {
+				uint64_t n = carry + a.pn[i + j] + (uint64_t)pn[j] * b.pn[i];
+				a.pn[i + j] = n & 0xffffffff;
+				carry = n >> 32;
+			}
+		}
+		*this = a;
+		return *this;
+	}
+	arith_uint256& operator<<=(unsigned int shift) {
+		arith_uint256 a(*this);
+		for (int i = 0; i < WIDTH; i++) { pn[i] = 0; }
+		int k = shift / 32;
+		shift = shift % 32;
+		for (int i = 0; i < WIDTH; i++) {
+			if (i + k + 1 < WIDTH && shift != 0) { pn[i + k + 1] |= (a.pn[i] >> (32 - shift)); }
+			if (i + k < WIDTH) { pn[i + k] |= (a.pn[i] << shift); }
+		}
+		return *this;
+	}
+	arith_uint256& operator>>=(unsigned int shift) {
+		arith_uint256 a(*this);
+		for (int i = 0; i < WIDTH; i++) { pn[i] = 0; }
+		int k = shift / 32;
+		shift = shift % 32;
+		for (int i = 0; i < WIDTH; i++) {
+			if (i - k - 1 >= 0 && shift != 0) { pn[i - k - 1] |= (a.pn[i] << (32 - shift)); }
+			if (i - k >= 0) { pn[i - k] |= (a.pn[i] >> shift); }
+		}
+		return *this;
+	}
+	// Shift-subtract long division, same as base_uint::operator/=. Divide by zero returns 0.
+	arith_uint256& operator/=(const arith_uint256& b) {
+		arith_uint256 div = b;
+		arith_uint256 num = *this;
+		*this = 0;
+		int num_bits = num.bits();
+		int div_bits = div.bits();
+		if (div_bits == 0 || div_bits > num_bits) { return *this; }
+		int shift = num_bits - div_bits;
+		div <<= shift;
+		while (shift >= 0) {
+			if (!(num < div)) {
+				num -= div;
+				pn[shift / 32] |= (1U << (shift & 31));
+			}
+			div >>= 1;
+			shift--;
+		}
+		return *this;
+	}
+	int compare(const arith_uint256& b) const {
+		for (int i = WIDTH - 1; i >= 0; i--) {
+			if (pn[i] < b.pn[i]) { return -1; }
+			if (pn[i] > b.pn[i]) { return 1; }
+		}
+		return 0;
+	}
+	unsigned int bits() const {
+		for (int pos = WIDTH - 1; pos >= 0; pos--) {
+			if (pn[pos]) {
+				for (int nbits = 31; nbits > 0; nbits--) {
+					if (pn[pos] & 1U << nbits) { return 32 * pos + nbits + 1; }
+				}
+				return 32 * pos + 1;
+			}
+		}
+		return 0;
+	}
+	double getdouble() const {
+		double ret = 0.0, fact = 1.0;
+		for (int i = 0; i < WIDTH; i++) { ret += fact * pn[i]; fact *= 4294967296.0; }
+		return ret;
+	}
+	uint64_t GetLow64() const { return pn[0] | (uint64_t)pn[1] << 32; }
+	std::string GetHex() const {
+		static const char hexdigits[] = "0123456789abcdef";
+		std::string s;
+		for (int i = WIDTH - 1; i >= 0; i--) {
+			for (int n = 28; n >= 0; n -= 4) { s += hexdigits[(pn[i] >> n) & 15]; }
+		}
+		return s;
+	}
+
+	friend arith_uint256 operator+(arith_uint256 a, const arith_uint256& b) { return a += b; }
+	friend arith_uint256 operator-(arith_uint256 a, const arith_uint256& b) { return a -= b; }
+	friend arith_uint256 operator*(arith_uint256 a, const arith_uint256& b) { return a *= b; }
+	friend arith_uint256 operator/(arith_uint256 a, const arith_uint256& b) { return a /= b; }
+	friend arith_uint256 operator<<(arith_uint256 a, unsigned int s) { return a <<= s; }
+	friend arith_uint256 operator>>(arith_uint256 a, unsigned int s) { return a >>= s; }
+	friend bool operator<(const arith_uint256& a, const arith_uint256& b) { return a.compare(b) < 0; }
+	friend bool operator>(const arith_uint256& a, const arith_uint256& b) { return a.compare(b) > 0; }
+	friend bool operator<=(const arith_uint256& a, const arith_uint256& b) { return a.compare(b) <= 0; }
+	friend bool operator>=(const arith_uint256& a, const arith_uint256& b) { return a.compare(b) >= 0; }
+	friend bool operator==(const arith_uint256& a, const arith_uint256& b) { return a.compare(b) == 0; }
+	friend bool operator!=(const arith_uint256& a, const arith_uint256& b) { return a.compare(b) != 0; }
+};
+
+#endif
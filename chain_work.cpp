@@ -29,9 +29,13 @@ Sum(Difficulty) * (N-1)/N is perfect only if difficulty is constant.
 #include <sstream>
 #include <string> 
 #include <math.h>  
+#include "phase_timing.h" // -DPHASE_TIMING for where the time goes
 using namespace std; 
 typedef double d;
 
+enum { PH_CALIBRATE, PH_SCALE, PH_MEANS, PH_TIPS, PH_OUTPUT, PHASES };
+const char* const PHASE_NAMES[PHASES] = {"calibrate", "scale", "means", "tips", "output"};
+
 d TARGET_TIME=0;
 d fRand(d fMin, d fMax) { d f=(d)rand() / RAND_MAX; return fMin+f*(fMax-fMin); }
 d print_out (d work, d HR, d H, string name) {
@@ -40,6 +44,7 @@ d print_out (d work, d HR, d H, string name) {
 }
 
 d run_simulation( long int TIPS, vector<d>D, vector<d>HR) {
+	PHASE_RESET();
 	// Back of vector D is the difficulty that's not yet solved.
 	d current_D = D.back(); 	D.pop_back();
 	d current_HR = HR.back();  HR.pop_back();
@@ -65,6 +70,7 @@ d run_simulation( long int TIPS, vector<d>D, vector<d>HR) {
 		}
 		avg_ST += sum_ST / TIPS; // avg TIP ST
 	}
+	PHASE(PH_CALIBRATE);
 	for (int j = 0; j < N; j++ ) { 	
 		D[j]	= D[j]*TARGET_TIME/avg_ST; 
 		sum_Ds	+= D[j];
@@ -93,6 +99,7 @@ d run_simulation( long int TIPS, vector<d>D, vector<d>HR) {
 	for (int j=0; j<N; j++) { cout << HR[j] << ", "; }
 	cout << " unsolved HR: " << current_HR;
 	cout << "\n\n";
+	PHASE(PH_SCALE);
 	
 	// Need to get means for Std Dev calculations
 	for (long int i=1; i <= TIPS ; i++) {
@@ -109,6 +116,7 @@ d run_simulation( long int TIPS, vector<d>D, vector<d>HR) {
 		m_A_hr	+= sum_actual_work / sum_ST / TIPS;
 		m_TT_hr	+= N/sum_TT_easiness*(N-1)/N / TIPS;
 	}
+	PHASE(PH_MEANS);
 
 	for (long int i=1; i <= TIPS ; i++) {
 		sum_ST = 0;
@@ -159,6 +167,7 @@ d run_simulation( long int TIPS, vector<d>D, vector<d>HR) {
 		avg_TT_HR		+= N/sum_TT_easiness*(N-1)/N / TIPS;	
 
 	}
+	PHASE(PH_TIPS);
 	cout << int(N) << " blocks took " << avg_ST << " solvetimes.\n";
 	cout << "A total of " << avg_ST << " solvetimes since split.\n";
 	cout << "\n" << avg_actual_work << " (work), " <<  
@@ -170,6 +179,8 @@ d run_simulation( long int TIPS, vector<d>D, vector<d>HR) {
 	print_out(avg_TT_work, avg_TT_HR,  avg_actual_HR,  "harmean(D/ST)*(N-1)/N  (Best HR, work is iffy)");
 	
 	cout << "\n"; 
+	PHASE(PH_OUTPUT);
+	PHASE_REPORT(cout, PHASE_NAMES, PHASES, false);
 	return 0;
 }
 
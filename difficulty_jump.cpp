@@ -1,117 +1,128 @@
-
-/*   
-
-There are very likely errors in this that will be very difficult to find 
-without fully understanding it which is difficult.
-
-Update:  the bnTarget returned is the target the miner has to solve and 
-the one that goes on chain for the baseline-DA. But
-the target this uses in the future is not that value, but
-ct[i] = bnTarget * bntime (solvetime)^2 * 1000 / 784 / T / T.  
-
-Preliminary code for super-fast increases in difficulty.   
-Requires the ability to change the difficulty during the current block,
-based on the timestamp the miner selects. See my github issue #36 and KMD.
-Needs intr-block exponential decay function because 
-this can make difficulty jump very high.
-Miners need to caclulate new difficulty with each second, or
-maybe 3 seconds.  FTL, MTP, and revert to local times must be small. 
-MTP=1 if using Digishield. Out-of-sequence timestamps must be forbidden.
-
-1) bnTarget = Digishield() or other baseline DA 
-2) bnTarget = RT_CST_RST() 
-3) bnTarget = max(bnTarget,expdecay())
-
-RT_CST_RST() multiplies Recent Target(s), Current Solvetimes, & 
-Recent SolveTime if RST had an unlikely 1/200 block chance of 
-being too fast on accident. This estimates and adjusts for recent 
-hashrate aggressively (lots of random error) but corrects the error by
-CST adjusting the difficulty during the block.
-
-It checks to see if there was an "active trigger" still in play which
-occurs when recent block emission rate has been too fast. Triggers 
-are supposed to be active if emission rate has not slowed up enough
-to get back on track. It checks the longest range first because it's
-the least aggressive.
-
-T = target blocktime 
-ts = timestamp vector, 62 elements, 62 is oldest  (elements needed are 50+W)
-ct = cumulative targets, 62 elements, 62 is oldest
-W = window size of recent solvetimes and targets to use that estimates hashrate
-numerator & deonominator needed for 1/200 possion estimator
-past = how far back in past to look for beginning of a trigger
-
-*/
-
-// create ts and ct vectors
-// Get bnTarget = Digishield();
-
-arith_uint256 past = 50;
-
-arith_uint256 W = 12;
-arith_uint256 numerator = 12;
-arith_uint256 denominator = 7;
-
-// bnTarget = RT_CST_RST (bnTarget, ts, ct, numerator, denominator, W, T, past);
-
-W = 6; top = 7; denominator = 3;
-
-// bnTarget = RT_CST_RST (bnTarget, ts, ct, numerator, denominator, W, T, past);
-
-W = 3; top = 1; denominator = 2;
-
-bnTarget = RT_CST_RST (bnTarget, ts, ct, numerator, denominator, W, T, past);
-
-arith_uint256 RT_CST_RST ( arith_uint256 bnTarget, std::vector<arith_uint256> ts, std::vector<arith_uint256> ct, 
-	arith_uint256 numerator, arith_uint256 denominator, arith_uint256 W, arith_uint256 T, arith_uint256 past  ) {
-
-	if (ts.size() < 2*W || ct.size() < 2*W ) { exit; } // error. a vector was too small 
-	if (ts.size() < past+W || ct.size() < past+W ) { past = min(ct.size(), ts.size()) - W; } // past was too small, adjust
-
-	arith_uint256 K = 1e6; // K is a scaling factor for integer divisions
-	int ii=0;
-
-	if ( ts[0]-ts[W+1] < T*numerator/denominator ) { 
-		bnTarget = ((ct[0]-ct[W])/K)*min(K,(K*(nTime-ts[0])*(ts[0]-ts[W])*denominator/numerator)/T/T);  
-	}
-
-	/*  Check past blocks for any sum of W STs < T*numerator/denominator triggers. This is messy
-	because the blockchain does not allow us to store a variable to know
-	if we are currently in a triggered state that is making a sequence of 
-	adjustments to prevTargets, so we have to look for them.
-
-	Nested loops do this: if block emission has not slowed to be back on track at 
-	any time since most recent trigger and we are at current block, aggressively
-	adust prevTarget. */
-
-	for ( int j=past-1; j>= 1; j--) {
-		if ( ts[j]-ts[j+W+1] < T*numerator/denominator ) {
-			ii=0;
-			for ( int i = j-1; i >= 0; i-- ) {
-				ii++;
-				// Check if emission caught up. If yes, "trigger stopped at i". 
-				// Break loop to try more recent j's to see if trigger activates again.
-				if ( ts[i]-ts[j+W] > (ii+W)*T ) { break; } 
-			
-				/* We're here, so there was a TS[j]-TS[j+W] < T*numer/denom trigger in the past 
-				and emission rate has not yet slowed up to be back on track so the 
-				"trigger is still active", aggressively adjusting target here at block "i" . */
-
-				if (i == 0) { 
-				
-					/* We made it all the way to current block. Emission rate since
-					last trigger never slowed enough to get back on track, so adjust again.
-					If avg last 3 STs = T, this increases target to prevTarget as ST increases to T. 
-					This biases it towards ST=~1.75*T to get emission back on track.
-					If avg last 3 STs = T/2, target increases to prevTarget at 2*T.
-					Rarely, last 3 STs can be 1/2 speed => target = prevTarget at T/2, & 1/2 at T.*/
-
-					bnTarget = ((ct[0]-ct[W])/W/K)*(K*(nTime-TS[0])*(ts[0]-ts[W]))/W/T/T; 
-					j=0; // It needed adjusting, we adjusted it, we're finished, so break out of j loop.
-				}
-			}
-		}
-	}
-return bnTarget;
-}
-
+// RT_CST_RST check and timing
+// Copyright (c) Zawy 2019, MIT License
+/*
+See difficulty_jump.h for the algorithm. This simulates a chain with on-off mining so that
+the 1/200 triggers happen a lot, and checks at every block (and several template timestamps
+per block) that RT_CST_RST_tracker gives exactly the same bnTarget as the 3 rescanning
+RT_CST_RST() calls, and that next_targets() gives the same curve as next_target() at every template
+timestamp. Then it times them. I compile and run this with:
+g++ -std=c++11 -O2 difficulty_jump.cpp -o difficulty_jump && ./difficulty_jump
+*/
+
+#include <iostream>
+#include <vector>
+#include <math.h>
+#include <ctime>
+#include <cstdlib>
+#include "difficulty_jump.h"
+using namespace std;
+typedef uint64_t u;
+
+double fRand(double fMin, double fMax) { double f = (double)rand() / RAND_MAX; return fMin + f*(fMax - fMin); }
+
+int main () {
+srand(time(0));
+
+u T = 600, past = 50, W_max = 12;
+u blocks = 100000;
+u n_ref = past + W_max + 1; // elements the rescanning version reads
+
+// Make a chain where hashrate jumps to 3x for a while now and then.
+vector<u> S(blocks);
+vector<uint256> targets(blocks);
+uint256 baseline = (~uint256(0))/u(1e12);
+S[0] = 1540000000;
+double HR = 1;
+for (u h = 0; h < blocks; h++) {
+	if (h > 0) {
+		if (fRand(0,1) < 0.01) { HR = (HR == 1) ? 3 : 1; }
+		S[h] = S[h-1] + u(T*log(1/fRand(0.000001,0.999999))/HR);
+	}
+	targets[h] = baseline/u(fRand(90,110))*100;
+}
+
+// Check
+RT_CST_RST_tracker rt(T, past);
+vector<u> ts(n_ref);
+vector<uint256> ct(n_ref);
+uint256 cum = 0, bnTarget;
+vector<uint256> cumulative(blocks);
+u checked = 0, errors = 0, triggered = 0;
+u offsets[4] = {1, T/3, T, 3*T};
+u curves = 0, curve_errors = 0;
+vector<uint256> curve;
+for (u h = 0; h < blocks; h++) {
+	cum += targets[h];
+	cumulative[h] = cum;
+	rt.add_block(S[h], targets[h]);
+	if (h+1 < n_ref) { continue; }
+	for (u i = 0; i < n_ref; i++) { ts[i] = S[h-i]; ct[i] = cumulative[h-i]; }
+	if (rt.active()) { triggered++; }
+	for (int k = 0; k < 4; k++) {
+		u nTime = S[h] + offsets[k];
+		bnTarget = targets[h];
+		bnTarget = RT_CST_RST (bnTarget, ts, ct, 12, 7, 12, T, past, nTime);
+		bnTarget = RT_CST_RST (bnTarget, ts, ct,  7, 3,  6, T, past, nTime);
+		bnTarget = RT_CST_RST (bnTarget, ts, ct,  1, 2,  3, T, past, nTime);
+		if (bnTarget != rt.next_target(targets[h], nTime)) {
+			if (errors < 10) { cout << "mismatch at height " << h << " nTime-ts[0] = " << offsets[k] << endl; }
+			errors++;
+		}
+		checked++;
+	}
+	if (h % 10 == 0) {
+		rt.next_targets(targets[h], S[h], 7, 1000, curve);
+		for (u k = 0; k < curve.size(); k++) {
+			if (curve[k] != rt.next_target(targets[h], S[h] + 7*k)) { curve_errors++; break; }
+		}
+		curves++;
+	}
+}
+cout << checked << " targets checked, " << errors << " mismatches. " << triggered << " of " << blocks <<
+	" blocks had an active trigger." << endl;
+cout << curves << " next_targets() curves checked, " << curve_errors << " differ." << endl;
+errors += curve_errors;
+
+// Time both
+clock_t start = clock();
+for (u h = n_ref; h < blocks; h++) {
+	for (u i = 0; i < n_ref; i++) { ts[i] = S[h-i]; ct[i] = cumulative[h-i]; }
+	bnTarget = targets[h];
+	bnTarget = RT_CST_RST (bnTarget, ts, ct, 12, 7, 12, T, past, S[h]+T);
+	bnTarget = RT_CST_RST (bnTarget, ts, ct,  7, 3,  6, T, past, S[h]+T);
+	bnTarget = RT_CST_RST (bnTarget, ts, ct,  1, 2,  3, T, past, S[h]+T);
+}
+double rescan = double(clock() - start)/CLOCKS_PER_SEC;
+start = clock();
+RT_CST_RST_tracker rt2(T, past);
+for (u h = 0; h < blocks; h++) {
+	rt2.add_block(S[h], targets[h]);
+	bnTarget = rt2.next_target(targets[h], S[h]+T);
+}
+double tracker = double(clock() - start)/CLOCKS_PER_SEC;
+start = clock();
+RT_CST_RST_tracker rt3(T, past);
+for (u h = 0; h < blocks; h++) { rt3.add_block(S[h], targets[h]); }
+double state_only = double(clock() - start)/CLOCKS_PER_SEC;
+// A 3600 point (1 per second for an hour) curve for every 100th block that has an active trigger.
+RT_CST_RST_tracker rt4(T, past);
+double curve_time = 0, point_time = 0;
+u timed_curves = 0;
+for (u h = 0; h < blocks; h++) {
+	rt4.add_block(S[h], targets[h]);
+	if (h % 100 || !rt4.active()) { continue; }
+	start = clock();
+	rt4.next_targets(targets[h], S[h], 1, 3600, curve);
+	curve_time += double(clock() - start)/CLOCKS_PER_SEC;
+	start = clock();
+	for (u k = 0; k < 3600; k++) { bnTarget = rt4.next_target(targets[h], S[h]+k); }
+	point_time += double(clock() - start)/CLOCKS_PER_SEC;
+	timed_curves++;
+}
+// Most of what's left in the tracker is uint256 division in the 2 formulas.
+cout << "rescanning RT_CST_RST x3: " << 1e9*rescan/(blocks-n_ref) << " ns/block. tracker: " <<
+	1e9*tracker/blocks << " ns/block (" << 1e9*state_only/blocks << " ns/block updating trigger state)." << endl;
+cout << "3600 point curve with a trigger active: next_targets() " << 1e6*curve_time/timed_curves << 
+	" us, next_target() x3600 " << 1e6*point_time/timed_curves << " us." << endl;
+return(errors > 0);
+}
@@ -0,0 +1,270 @@
+
+/*
+
+There are very likely errors in this that will be very difficult to find
+without fully understanding it which is difficult.
+
+Update:  the bnTarget returned is the target the miner has to solve and
+the one that goes on chain for the baseline-DA. But
+the target this uses in the future is not that value, but
+ct[i] = bnTarget * bntime (solvetime)^2 * 1000 / 784 / T / T.
+
+Preliminary code for super-fast increases in difficulty.
+Requires the ability to change the difficulty during the current block,
+based on the timestamp the miner selects. See my github issue #36 and KMD.
+Needs intr-block exponential decay function because
+this can make difficulty jump very high.
+Miners need to caclulate new difficulty with each second, or
+maybe 3 seconds.  FTL, MTP, and revert to local times must be small.
+MTP=1 if using Digishield. Out-of-sequence timestamps must be forbidden.
+
+1) bnTarget = Digishield() or other baseline DA
+2) bnTarget = RT_CST_RST()
+3) bnTarget = max(bnTarget,expdecay())
+
+RT_CST_RST() multiplies Recent Target(s), Current Solvetimes, &
+Recent SolveTime if RST had an unlikely 1/200 block chance of
+being too fast on accident. This estimates and adjusts for recent
+hashrate aggressively (lots of random error) but corrects the error by
+CST adjusting the difficulty during the block.
+
+It checks to see if there was an "active trigger" still in play which
+occurs when recent block emission rate has been too fast. Triggers
+are supposed to be active if emission rate has not slowed up enough
+to get back on track. It checks the longest range first because it's
+the least aggressive.
+
+T = target blocktime
+ts = timestamp vector, 62 elements, 62 is oldest  (elements needed are 50+W)
+ct = cumulative targets, 62 elements, 62 is oldest
+W = window size of recent solvetimes and targets to use that estimates hashrate
+numerator & deonominator needed for 1/200 possion estimator
+past = how far back in past to look for beginning of a trigger
+
+The 3 calls are W=12 (12/7), W=6 (7/3), and W=3 (1/2), each one overriding the last:
+
+	bnTarget = RT_CST_RST (bnTarget, ts, ct, 12, 7, 12, T, 50);
+	bnTarget = RT_CST_RST (bnTarget, ts, ct,  7, 3,  6, T, 50);
+	bnTarget = RT_CST_RST (bnTarget, ts, ct,  1, 2,  3, T, 50);
+
+RT_CST_RST() below is the rescanning version as written. It looks at past*W timestamps 3 times
+per block. RT_CST_RST_tracker gives the same bnTarget by keeping the trigger state as blocks
+are added so each block costs O(1) per W. Use it like this:
+
+	RT_CST_RST_tracker rt(T);
+	rt.add_block(timestamp, target);  // for every block, in order
+	bnTarget = rt.next_target(bnTarget, nTime);  // bnTarget from the baseline DA
+
+uint256 (uint256.h) stands in for the node's arith_uint256. It wraps the same way.
+
+*/
+#ifndef DIFFICULTY_JUMP_H
+#define DIFFICULTY_JUMP_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include "uint256.h"
+
+inline uint256 RT_CST_RST ( uint256 bnTarget, const std::vector<uint64_t>& ts, const std::vector<uint256>& ct,
+	uint64_t numerator, uint64_t denominator, uint64_t W, uint64_t T, uint64_t past, uint64_t nTime ) {
+
+	if (ts.size() < 2*W || ct.size() < 2*W ) { return bnTarget; } // error. a vector was too small
+	// past was too small, adjust. The j loop reads ts[past+W].
+	if (ts.size() < past+W+1 || ct.size() < past+W+1 ) { past = std::min(ct.size(), ts.size()) - W - 1; }
+
+	uint256 K = 1e6; // K is a scaling factor for integer divisions
+	int ii=0;
+
+	if ( ts[0]-ts[W+1] < T*numerator/denominator ) {
+		bnTarget = ((ct[0]-ct[W])/K)*std::min(K,(K*(uint256(nTime)-ts[0])*(ts[0]-ts[W])*denominator/numerator)/T/T);
+	}
+
+	/*  Check past blocks for any sum of W STs < T*numerator/denominator triggers. This is messy
+	because the blockchain does not allow us to store a variable to know
+	if we are currently in a triggered state that is making a sequence of
+	adjustments to prevTargets, so we have to look for them.
+
+	Nested loops do this: if block emission has not slowed to be back on track at
+	any time since most recent trigger and we are at current block, aggressively
+	adust prevTarget. */
+
+	for ( int j=past-1; j>= 1; j--) {
+		if ( ts[j]-ts[j+W+1] < T*numerator/denominator ) {
+			ii=0;
+			for ( int i = j-1; i >= 0; i-- ) {
+				ii++;
+				// Check if emission caught up. If yes, "trigger stopped at i".
+				// Break loop to try more recent j's to see if trigger activates again.
+				if ( ts[i]-ts[j+W] > (ii+W)*T ) { break; }
+
+				/* We're here, so there was a TS[j]-TS[j+W] < T*numer/denom trigger in the past
+				and emission rate has not yet slowed up to be back on track so the
+				"trigger is still active", aggressively adjusting target here at block "i" . */
+
+				if (i == 0) {
+
+					/* We made it all the way to current block. Emission rate since
+					last trigger never slowed enough to get back on track, so adjust again.
+					If avg last 3 STs = T, this increases target to prevTarget as ST increases to T.
+					This biases it towards ST=~1.75*T to get emission back on track.
+					If avg last 3 STs = T/2, target increases to prevTarget at 2*T.
+					Rarely, last 3 STs can be 1/2 speed => target = prevTarget at T/2, & 1/2 at T.*/
+
+					bnTarget = ((ct[0]-ct[W])/W/K)*(K*(uint256(nTime)-ts[0])*(ts[0]-ts[W]))/W/T/T;
+					j=0; // It needed adjusting, we adjusted it, we're finished, so break out of j loop.
+				}
+			}
+		}
+	}
+return bnTarget;
+}
+
+// ===============================================
+// =======  Incremental RT_CST_RST tracker  =======
+// ===============================================
+/* Let g(x) = ts(x) - x*T for block height x. A trigger at height a (ts(a)-ts(a-W-1) < T*num/den) is
+still active at the tip h if ts(b)-ts(a-W) <= (b-a+W)*T for every b in (a,h], i.e. if
+g(a-W) >= max g(b). Once a later block breaks that it stays broken, so each W keeps a deque of
+live triggers in height order. A trigger that is older and has a smaller-or-equal key than a newer
+one dies first and leaves the "past" window first, so it is dropped. That leaves the keys strictly
+decreasing from front to back: new blocks kill from the back, the past window expires the front,
+and "is any trigger active" is "is the deque not empty".  Timestamps must not go backwards. */
+
+class RT_CST_RST_tracker {
+public:
+	// state: 0 = not triggered, 1 = trigger at the tip (first formula), 2 = older trigger still active (second)
+	struct window {
+		uint64_t W, numerator, denominator;
+		int state;
+		uint256 sum_targets; // ct[0]-ct[W]
+		uint64_t span; // ts[0]-ts[W]
+		std::vector<uint64_t> trigger_height;
+		std::vector<int64_t> trigger_key;
+		uint64_t head, count;
+	};
+	static const int WINDOWS = 3;
+
+	RT_CST_RST_tracker(uint64_t T_, uint64_t past_ = 50) : T(T_), past(past_), height(0) {
+		uint64_t Ws[WINDOWS][3] = { {12, 12, 7}, {6, 7, 3}, {3, 1, 2} };
+		W_max = 0;
+		for (int k = 0; k < WINDOWS; k++) {
+			w[k].W = Ws[k][0]; w[k].numerator = Ws[k][1]; w[k].denominator = Ws[k][2];
+			w[k].state = 0; w[k].span = 0;
+			w[k].trigger_height.assign(past+1, 0);
+			w[k].trigger_key.assign(past+1, 0);
+			w[k].head = 0; w[k].count = 0;
+			W_max = std::max(W_max, w[k].W);
+		}
+		ts.assign(W_max+2, 0);
+		ct.assign(W_max+2, 0);
+	}
+
+	// Add the next block. target is what goes into ct (see the Update note above).
+	void add_block(uint64_t timestamp, const uint256& target) {
+		uint64_t h = height, R = ts.size();
+		if (h > 0) { assert(timestamp >= ts[(h-1) % R]); }
+		ts[h % R] = timestamp;
+		ct[h % R] = (h > 0 ? ct[(h-1) % R] : uint256(0)) + target;
+		int64_t g = int64_t(timestamp) - int64_t(h*T);
+
+		for (int k = 0; k < WINDOWS; k++) {
+			window& x = w[k];
+			uint64_t W = x.W, cap = x.trigger_key.size();
+			// A block that catches emission back up kills every trigger with a smaller key.
+			while (x.count > 0 && x.trigger_key[(x.head + x.count - 1) % cap] < g) { x.count--; }
+			// j <= past-1
+			while (x.count > 0 && x.trigger_height[x.head] + past <= h) { x.head = (x.head+1) % cap; x.count--; }
+
+			bool trigger = h >= W+1 && timestamp - ts[(h-W-1) % R] < T*x.numerator/x.denominator;
+			x.state = x.count > 0 ? 2 : (trigger ? 1 : 0);
+			if (h >= W) {
+				x.sum_targets = ct[h % R] - ct[(h-W) % R];
+				x.span = timestamp - ts[(h-W) % R];
+			}
+			if (trigger) {
+				int64_t key = int64_t(ts[(h-W) % R]) - int64_t((h-W)*T);
+				while (x.count > 0 && x.trigger_key[(x.head + x.count - 1) % cap] <= key) { x.count--; }
+				x.trigger_height[(x.head + x.count) % cap] = h;
+				x.trigger_key[(x.head + x.count) % cap] = key;
+				x.count++;
+			}
+		}
+		height++;
+	}
+
+	// Same result as the 3 RT_CST_RST() calls on the blocks added so far.
+	uint256 next_target(uint256 bnTarget, uint64_t nTime) const {
+		if (height == 0) { return bnTarget; }
+		uint256 K = 1e6;
+		uint64_t tip = ts[(height-1) % ts.size()];
+		for (int k = 0; k < WINDOWS; k++) {
+			const window& x = w[k];
+			if (x.state == 1) {
+				bnTarget = (x.sum_targets/K)*std::min(K,(K*(uint256(nTime)-tip)*x.span*x.denominator/x.numerator)/T/T);
+			}
+			else if (x.state == 2) {
+				bnTarget = (x.sum_targets/x.W/K)*(K*(uint256(nTime)-tip)*x.span)/x.W/T/T;
+			}
+		}
+		return bnTarget;
+	}
+	/* next_target() for nTime = nTime0 + k*step, k < points, into targets. For a template this is the whole
+	curve a miner needs. Only the last triggered window matters, its factor is linear in nTime, so it's stepped
+	as quotient and remainder instead of dividing a uint256 at every point. The 2nd formula multiplies before it
+	divides, so that product is stepped mod 2^256 the same way it wraps, and redone with a divide if it wraps. */
+	void next_targets(const uint256& bnTarget, uint64_t nTime0, uint64_t step, uint64_t points, std::vector<uint256>& targets) const {
+		targets.assign(points, bnTarget);
+		const window* x = active();
+		if (!x || points == 0) { return; }
+		uint64_t tip = ts[(height-1) % ts.size()];
+		assert(nTime0 >= tip);
+		uint64_t K = 1e6, dt = nTime0 - tip;
+		if (x->state == 1) {
+			// min(K, K*dt*span*denominator/numerator/T/T)
+			uint64_t d = x->numerator*T*T;
+			uint256 A = x->sum_targets/K, v = uint256(K)*dt*x->span*x->denominator, dv = uint256(K)*step*x->span*x->denominator;
+			uint256 q = v, dq = dv;
+			uint64_t r = q.divmod(d), dr = dq.divmod(d);
+			for (uint64_t k = 0; k < points; k++) {
+				if (q >= K) { uint256 AK = A*K; for (; k < points; k++) { targets[k] = AK; } break; }
+				targets[k] = A*q.GetLow64();
+				q += dq; r += dr;
+				if (r >= d) { r -= d; q += 1; }
+			}
+		}
+		else {
+			// (sum/W/K)*(K*dt*span)/W/T/T
+			uint64_t d = x->W*T*T;
+			uint256 P = (x->sum_targets/x->W/K)*(uint256(K)*dt*x->span), dP = (x->sum_targets/x->W/K)*(uint256(K)*step*x->span);
+			uint256 q = P, dq = dP;
+			uint64_t r = q.divmod(d), dr = dq.divmod(d);
+			for (uint64_t k = 0; k < points; k++) {
+				targets[k] = q;
+				uint256 next = P + dP;
+				if (next < P) { q = next; r = q.divmod(d); } // wrapped
+				else {
+					q += dq; r += dr;
+					if (r >= d) { r -= d; q += 1; }
+				}
+				P = next;
+			}
+		}
+	}
+	// The window that sets the target (the last triggered one), or 0 if none triggered.
+	const window* active() const {
+		const window* a = 0;
+		for (int k = 0; k < WINDOWS; k++) { if (w[k].state) { a = &w[k]; } }
+		return a;
+	}
+	uint64_t blocks() const { return height; }
+
+private:
+	uint64_t T, past, height, W_max;
+	window w[WINDOWS];
+	std::vector<uint64_t> ts; // ring of the last W_max+2 timestamps
+	std::vector<uint256> ct; // ring of the last W_max+2 cumulative targets
+};
+
+#endif
@@ -0,0 +1,115 @@
+// Compile-time removable phase timing
+// Copyright (c) Zawy 2019, MIT License
+/*
+Where a run's time goes: the DA, sampling solvetimes, shifting windows, the metrics, file writes. Compile with
+-DPHASE_TIMING to turn it on. Without it every macro here is nothing, so the loops are the same code as before.
+A program names its phases with an enum and an array of names, calls PHASE_RESET() when a run starts, and puts
+PHASE(p) at the end of each piece of work, which charges the time since the last mark to phase p. So a mark is one
+clock read (rdtsc on x86, steady_clock elsewhere). A read is about 20 ns, which is too much to do several times a
+block, so in a block loop PHASE_SAMPLE(i) only times and counts 1 block in PHASE_SAMPLE_EVERY and scales them up. The
+other blocks only test a flag at each mark, which keeps it under 2% of EMA_'s 120 ns blocks, the cheapest DA.
+PHASE_ALL() goes back to timing everything, for the work after the loop. PHASE_BYTES(p, n)
+adds bytes written. PHASE_REPORT() prints the table for the run so far, with ticks converted to ms by the
+ticks per ns over the whole run, and an estimate of what the marks cost. Counters are per thread, so parallel runs
+don't share cache lines and each thread reports its own runs.
+*/
+#ifndef PHASE_TIMING_H
+#define PHASE_TIMING_H
+
+#ifdef PHASE_TIMING
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <ostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+inline uint64_t phase_ticks() { return __rdtsc(); }
+#else
+inline uint64_t phase_ticks() { return std::chrono::steady_clock::now().time_since_epoch().count(); }
+#endif
+inline uint64_t phase_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const int MAX_PHASES = 16;
+const uint64_t PHASE_SAMPLE_EVERY = 256; // a power of 2
+
+struct phase_state {
+	uint64_t ticks[MAX_PHASES], calls[MAX_PHASES], bytes[MAX_PHASES];
+	uint64_t mark, weight, reads, start_ticks, start_ns;
+	bool on, sampled;
+};
+inline phase_state& phase_counters() { static thread_local phase_state s; return s; }
+
+inline void phase_reset() {
+	phase_state& s = phase_counters();
+	s = phase_state();
+	s.on = true; s.weight = 1;
+	s.start_ns = phase_ns(); s.start_ticks = s.mark = phase_ticks();
+}
+// The clock reads are out of line so the blocks that aren't timed only test a flag.
+__attribute__((noinline, cold)) inline void phase_start(uint64_t weight) {
+	phase_state& s = phase_counters();
+	s.on = true; s.weight = weight; s.mark = phase_ticks(); s.reads++;
+}
+__attribute__((noinline, cold)) inline void phase_time(int p) {
+	phase_state& s = phase_counters();
+	uint64_t t = phase_ticks();
+	s.calls[p] += s.weight;
+	s.ticks[p] += (t - s.mark)*s.weight;
+	s.mark = t; s.reads++;
+}
+inline void phase_sample(uint64_t i) {
+	if ((i & (PHASE_SAMPLE_EVERY-1)) == 0) { phase_start(PHASE_SAMPLE_EVERY); phase_counters().sampled = true; }
+	else { phase_counters().on = false; }
+}
+inline void phase_all() { phase_start(1); }
+inline void phase_mark(int p) { if (phase_counters().on) { phase_time(p); } }
+
+inline void phase_report(std::ostream& out, const char* const names[], int n, bool html) {
+	phase_state& s = phase_counters();
+	uint64_t ticks = phase_ticks() - s.start_ticks, ns = phase_ns() - s.start_ns;
+	double ns_per_tick = ticks ? double(ns)/ticks : 0;
+	// What a clock read costs, for the overhead estimate.
+	uint64_t t0 = phase_ns(), sink = 0;
+	for (int k = 0; k < 1000; k++) { sink += phase_ticks(); }
+	double read_ns = (phase_ns() - t0 + (sink & 1))/1000.0;
+	uint64_t calls = 0;
+	for (int p = 0; p < n; p++) { calls += s.calls[p]; }
+	char line[160];
+	snprintf(line, sizeof(line), "%-15s\t%-12s\t%s\t%s\t%s\t%s\n", "phase", "calls", "ms", "% of run", "ns/call", "bytes");
+	out << (html ? "<pre>" : "") << line;
+	for (int p = 0; p < n; p++) {
+		if (!s.calls[p]) { continue; }
+		double ms = s.ticks[p]*ns_per_tick/1e6;
+		snprintf(line, sizeof(line), "%-15s\t%-12llu\t%.2f\t%.1f\t\t%.1f\t%llu\n", names[p], (unsigned long long)s.calls[p],
+			ms, ns ? 1e8*ms/ns : 0, 1e6*ms/s.calls[p], (unsigned long long)s.bytes[p]);
+		out << line;
+	}
+	char sampled[64] = "";
+	if (s.sampled) { snprintf(sampled, sizeof(sampled), "block loop phases timed and counted on 1 block in %llu, ", 
+		(unsigned long long)PHASE_SAMPLE_EVERY); }
+	snprintf(line, sizeof(line), "%.2f ms run, %smarks about %.2f%% of it\n", ns/1e6, sampled,
+		ns ? 100*(s.reads*read_ns + calls*0.5)/ns : 0);
+	out << line << (html ? "</pre>" : "");
+}
+
+#define PHASE_RESET() phase_reset()
+#define PHASE_SAMPLE(i) phase_sample(i)
+#define PHASE_ALL() phase_all()
+#define PHASE(p) phase_mark(p)
+#define PHASE_BYTES(p, n) (phase_counters().bytes[p] += (n))
+#define PHASE_REPORT(out, names, n, html) phase_report(out, names, n, html)
+
+#else
+
+#define PHASE_RESET() ((void)0)
+#define PHASE_SAMPLE(i) ((void)0)
+#define PHASE_ALL() ((void)0)
+#define PHASE(p) ((void)0)
+#define PHASE_BYTES(p, n) ((void)0)
+#define PHASE_REPORT(out, names, n, html) ((void)0)
+
+#endif
+#endif
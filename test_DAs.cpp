@@ -3,9 +3,10 @@ Copyright (c) 2018-2020 by Zawy, MIT license.
 This tests various difficulty algorithms. Unfortunately, the algorithms are terms of difficulty instead of targets. 
 This is a consequence of initially being for CryptoNote-type code. It's complicated because it's 
 flexible. See main() to select algorithm(s) and settings. It can simulate on-off mining. It outputs 
-timestamps and difficulties to screen, file, and gnuplot. There are no inputs to the program except what's in main().
+timestamps and difficulties to screen, file, and gnuplot. There are no inputs to the program except what's in main(), 
+other than the modes at the top of main() such as replaying a recorded chain through the DAs.
 You compile and run this then refresh "test_DAs.html" in a browser to see the output. I compile and run this with: 
-g++ -std=c++11 test_DAs.cpp -o test_DAs && ./test_DAs
+g++ -std=c++11 -O2 -pthread test_DAs.cpp -o test_DAs && ./test_DAs
 
 Several of the algorithms get average target by using the harmonic mean of difficulties which uses a 1E13 factor
 that may cause overflow or underflow depending on difficulty, T, and N. Difficulty is usuallly ok in the range 1E4 to 1E13.
@@ -20,6 +21,14 @@ instead of past difficulties should not use any of this code directly, but rewri
 #include <string> 
 #include <math.h>  // needed for log()
 #include <cassert>  // wownero said this was needed
+#include <sys/mman.h> // mmap for replaying recorded headers
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h> // Unix socket for the next-difficulty service
+#include <sys/un.h>
+#include "difficulty_jump.h" // RT_CST_RST_tracker
+#include "phase_timing.h" // compile with -DPHASE_TIMING for where a run's time goes
 
 // This is supposed to be a bad idea that reduces clutter.
 using namespace std;
@@ -35,13 +44,84 @@ vector<float>NEG_LOG_RAND(0);
 u BLOCKS, FORK_HEIGHT, START_TIMESTAMP, START_CD, BASELINE_D, USE_CN_DELAY, DX, ENABLE_FILE_WRITES, PRINT_BLOCKS_TO_COMMAND_LINE; 
 // The following are for TSA
 u CONSTANT_HR(1), HR_NEW_METHOD(1), IDENTIFIER(0), R=4;
+u QUIET(0); // 1 = run_simulation() doesn't print or write files, it only fills in sim_metrics
 
 float fRand(float fMin, float fMax) {	
 		float f = (float)rand() / RAND_MAX;
 	 return fMin + f * (fMax - fMin);
 }
 
-simulate_ST (u D, u DX, u HR_base, u T, u HR_profile) { }
+// ==============================================
+//  =========	HASHRATE PROFILES  ==============
+// ==============================================
+/* The baseline hashrate is multiplied by a profile of time since START_TIMESTAMP. It is made once into a buffer of 
+one multiplier per "bucket" seconds, so looking it up in the block loop is an index and a clamp, and parallel runs can 
+share it read-only. Past the end of the buffer the last value holds. The HR of a block is the HR when it starts. 
+The on-off attack (attack_start, attack_stop, attack_size in main) multiplies on top of it. Specs:
+	constant                       
+	step:seconds:x                 x times baseline after seconds
+	ramp:from:to:x                 1 before "from" seconds, x after "to", linear between
+	diurnal:a                      1 + a*sin(2*pi*seconds/86400)
+	random_walk:sigma              log of the multiplier moves sigma per sqrt(hour)
+	file:path                      "seconds multiplier" lines in increasing seconds
+The on-off threshold profile is "constant" with attack_size != 100.  */
+struct hashrate_profile {
+	u start = 0, bucket = 60;
+	vector<float> m;
+	float at(u timestamp) const {
+		if (m.empty()) { return 1; }
+		u k = timestamp > start ? (timestamp - start)/bucket : 0;
+		return m[std::min(k, u(m.size()-1))];
+	}
+};
+hashrate_profile HR_PROFILE;
+
+hashrate_profile make_hashrate_profile(const string& spec, u duration, u bucket = 60) {
+	hashrate_profile p;
+	p.start = START_TIMESTAMP; p.bucket = bucket;
+	vector<string> f;
+	stringstream ss(spec);
+	for (string x; getline(ss, x, ':'); ) { f.push_back(x); }
+	u n = duration/bucket + 1;
+	p.m.assign(n, 1);
+	if (f[0] == "constant") { }
+	else if (f[0] == "step" && f.size() == 3) {
+		for (u k = stoull(f[1])/bucket; k < n; k++) { p.m[k] = stof(f[2]); }
+	}
+	else if (f[0] == "ramp" && f.size() == 4) {
+		double from = stod(f[1]), to = stod(f[2]), x = stod(f[3]);
+		for (u k = 0; k < n; k++) { 
+			double t = double(k*bucket);
+			p.m[k] = t <= from ? 1 : t >= to ? x : 1 + (x-1)*(t-from)/(to-from); 
+		}
+	}
+	else if (f[0] == "diurnal" && f.size() == 2) {
+		for (u k = 0; k < n; k++) { p.m[k] = 1 + stod(f[1])*sin(2*M_PI*double(k*bucket)/86400); }
+	}
+	else if (f[0] == "random_walk" && f.size() == 2) {
+		double sd = stod(f[1])*sqrt(bucket/3600.0), log_m = 0;
+		for (u k = 1; k < n; k++) { 
+			// Box-Muller
+			log_m += sd*sqrt(-2*log(fRand(0.000001,0.999999)))*cos(2*M_PI*fRand(0,1)); 
+			p.m[k] = exp(log_m);
+		}
+	}
+	else if (f[0] == "file" && f.size() == 2) {
+		ifstream in(f[1]);
+		if (!in) { cout << "Can't read " << f[1] << endl; exit(1); }
+		double t, x, last = 1;
+		u k = 0;
+		while (in >> t >> x) {
+			for (; k < n && k*bucket < t; k++) { p.m[k] = last; }
+			last = x;
+		}
+		for (; k < n; k++) { p.m[k] = last; }
+	}
+	else { cout << "Unknown hashrate profile " << spec << endl; exit(1); }
+	return p;
+}
+
+u simulate_ST (u D, u DX, u HR, float neg_log_rand) { return static_cast<u>(neg_log_rand*D*DX/HR); }
 
 u exponential_function_for_integers (u x_times_1M) {
 	// This calculates e^x without decimals by passing it an integer x_times_1M and getting 
@@ -64,7 +144,7 @@ u exponential_function_for_integers (u x_times_1M) {
 	return exx;
 }
 
-u harmonic_mean (vector<u>cumulative_difficulties, u N) {
+u harmonic_mean (const vector<u>& cumulative_difficulties, u N) {
 	u tar=0;
 	for (u i=1; i <= N; i++ ) {
 		tar += 1e13/(cumulative_difficulties[i]-cumulative_difficulties[i-1]);
@@ -72,7 +152,7 @@ u harmonic_mean (vector<u>cumulative_difficulties, u N) {
 	return N*1e13/tar;
 }
 
-u solvetime_without_exploits (std::vector<u>timestamps, u T) {
+u solvetime_without_exploits (const std::vector<u>& timestamps, u T) {
 	u previous_timestamp(0), this_timestamp(0), ST, i;
 	previous_timestamp = timestamps.front()-T;
 	for ( i = 0; i < timestamps.size(); i++) {
@@ -86,8 +166,8 @@ u solvetime_without_exploits (std::vector<u>timestamps, u T) {
 // ===============================================
 // =======  Simple Moving Average (SMA)	========
 // ===============================================
-u SMA_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u SMA_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u difficulty_guess) {
 	// If it's Genesis ...
 	if (height <= N+1 ) { return difficulty_guess; }
@@ -106,8 +186,8 @@ u SMA_(std::vector<u> timestamps,
 // =======  SMA with Slope Adjustment (SMS)	========
 // ===============================================
 // I thought this would be better than SMA, but it's not.  Maybe a little worse. I needed to do it with targets.
-u SMS_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u SMS_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u difficulty_guess) {
 	if (height <= N+1 ) { return difficulty_guess; }
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
@@ -126,8 +206,8 @@ u SMS_(std::vector<u> timestamps,
 // DGW_ uses an insanely complicated loop that is a simple moving average with double
 // weight given to the most recent difficulty, which has virtually no effect.  So this 
 // is just a SMA_ with the 1/3 and 3x limits in DGW_.
-u DGW_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u DGW_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u  difficulty_guess) {
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
@@ -143,8 +223,8 @@ u DGW_(std::vector<u> timestamps,
 // Digishield uses the median of past 11 timestamps as the beginning and end of the window.
 // This only simulates that, assuming the timestamps are always in the correct order.
 // Also, this is in terms of difficulty instead of target, so a "101/100" correction factor was used.
-u DIGISHIELD_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u DIGISHIELD_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 	u FORK_HEIGHT,u  difficulty_guess) {
 
 	// Genesis should be the only time sizes are < N+1.
@@ -165,8 +245,8 @@ u DIGISHIELD_(std::vector<u> timestamps,
 // ===========================================
 // ==========	improved Digishield	(6-block timestamp delay removed)
 // ===========================================
-u DIGISHIELD_improved_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u DIGISHIELD_improved_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u  difficulty_guess) {
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
 
@@ -197,8 +277,8 @@ u DIGISHIELD_improved_(std::vector<u> timestamps,
 // https://github.com/loki-project/loki/pull/26	or
 // https://github.com/graft-project/GraftNetwork/pull/118/files
 
-u LWMA1_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,  
+u LWMA1_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,  
 					u FORK_HEIGHT,u  difficulty_guess) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -233,8 +313,8 @@ u LWMA1_(std::vector<u> timestamps,
 // https://github.com/zawy12/difficulty-algorithms/issues/3
 // See commented version for explanations & required config file changes. Fix FTL and MTP!
 
-u LWMA4_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,  
+u LWMA4_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,  
 					u FORK_HEIGHT,u  difficulty_guess) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -245,7 +325,8 @@ u LWMA4_(std::vector<u> timestamps,
 	u  L(0), ST(0), next_D, prev_D, avg_D, i;
 
 	// Safely convert out-of-sequence timestamps into > 0 solvetimes.
-	std::vector<u>TS(N+1);
+	static thread_local std::vector<u>TS;  TS.resize(N+1); // no allocation per block
+
 	TS[0] = timestamps[0];
 	for ( i = 1; i <= N; i++) {		  
 		if ( timestamps[i]  > TS[i-1]  ) {	TS[i] = timestamps[i];  } 
@@ -297,8 +378,8 @@ u LWMA4_(std::vector<u> timestamps,
 // hashrate (difficulty/solvetime) instead of solvetimes could be made as good as 
 // or better than LWMA. Yes, it was as good, but not better.
 
-u WHR_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,  
+u WHR_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,  
 					u FORK_HEIGHT,u  difficulty_guess) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -308,7 +389,7 @@ u WHR_(std::vector<u> timestamps,
 	assert(timestamps.size() == N+1); 
 
 	u  L(0), next_D, i, this_timestamp(0), previous_timestamp(0), avg_D, j(0);
-	u ts =0, WHR, tar1, tar2;
+	u ts =0, WHR(0), tar1, tar2;
 //	if (height % 2) { // The if-else statement was not as accurate.
 		previous_timestamp=timestamps[0];
 		for ( i = 2; i <= N; i+=2) {	
@@ -334,8 +415,8 @@ u WHR_(std::vector<u> timestamps,
 // hashrate (difficulty/solvetime) instead of solvetimes could be made as good as 
 // or better than LWMA. Yes, it was as good, but not better.
 
-u LWMA_ASERT_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,  
+u LWMA_ASERT_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,  
 					u FORK_HEIGHT,u  difficulty_guess, u M) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -345,7 +426,7 @@ u LWMA_ASERT_(std::vector<u> timestamps,
 	assert(timestamps.size() == N+1); 
 
 	u  L(0), next_D, i, this_timestamp(0), previous_timestamp(0), avg_D;
-	u ST =0, WHR, tar1, exp_B, exp_A;
+	u ST =0, WHR(0), tar1, exp_B, exp_A;
 		previous_timestamp=timestamps[0];
 		for ( i = 1; i <= N; i++) {		  
 			// Safely prevent out-of-sequence timestamps
@@ -365,7 +446,7 @@ u LWMA_ASERT_(std::vector<u> timestamps,
 // ========	TSA	===========
 // ============================
 
-u TSA_(std::vector<u> timestamps, std::vector<u> cumulative_difficulties, u T, u N, u height,  
+u TSA_(const std::vector<u>& timestamps, const std::vector<u>& cumulative_difficulties, u T, u N, u height,  
 				u FORK_HEIGHT, u  difficulty_guess, u template_timestamp, u M ) {
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
@@ -392,11 +473,11 @@ is 7*144 blocks, but you quit the loop early with a smaller averaging window if
 come too fast or too slow by ratio or 1/ratio. The equation is only 
 good for 144, but it does not need to change if target solvetime changes.
 */ 
-u Boris_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u uT, u uN, u height,  
+u Boris_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u uT, u uN, u height,  
 					u FORK_HEIGHT,u  difficulty_guess) {
-float SlowBlocksLimit[1050] = {0.00315,0.00734,0.0120,0.0170,0.0223,0.0277,0.0333,0.0380,0.0447,0.0507,0.0566,0.0626,0.0686,0.0746,0.0807,0.0868,0.0929,0.0980,0.105,0.111,0.117,0.123,0.129,0.135,0.141,0.147,0.153,0.158,0.164,0.170,0.176,0.182,0.187,0.193,0.199,0.204,0.210,0.215,0.221,0.226,0.231,0.237,0.242,0.247,0.252,0.257,0.263,0.268,0.273,0.278,0.282,0.287,0.292,0.297,0.302,0.306,0.311,0.316,0.320,0.325,0.329,0.334,0.338,0.342,0.347,0.351,0.355,0.359,0.363,0.367,0.372,0.376,0.380,0.383,0.387,0.391,0.395,0.399,0.403,0.406,0.410,0.414,0.417,0.421,0.424,0.428,0.431,0.435,0.438,0.442,0.445,0.448,0.452,0.455,0.458,0.461,0.464,0.468,0.471,0.474,0.477,0.480,0.483,0.486,0.489,0.492,0.495,0.497,0.500,0.503,0.506,0.509,0.511,0.514,0.517,0.519,0.522,0.525,0.527,0.530,0.532,0.535,0.537,0.540,0.542,0.545,0.547,0.549,0.552,0.554,0.556,0.559,0.561,0.563,0.565,0.568,0.570,0.572,0.574,0.576,0.579,0.581,0.583,0.585,0.587,0.589,0.591,0.593,0.595,0.597,0.599,0.601,0.603,0.605,0.607,0.608,0.610,0.612,0.614,0.616,0.618,0.619,0.621,0.623,0.625,0.626,0.628,0.630,0.632,0.633,0.635,0.637,0.638,0.640,0.642,0.643,0.645,0.646,0.648,0.649,0.651,0.653,0.654,0.656,0.657,0.659,0.660,0.661,0.663,0.664,0.666,0.667,0.669,0.670,0.671,0.673,0.674,0.676,0.677,0.678,0.680,0.681,0.682,0.684,0.685,0.686,0.687,0.689,0.690,0.691,0.692,0.694,0.695,0.696,0.697,0.699,0.700,0.701,0.702,0.703,0.704,0.706,0.707,0.708,0.709,0.710,0.711,0.712,0.713,0.714,0.716,0.717,0.718,0.719,0.720,0.721,0.722,0.723,0.724,0.725,0.726,0.727,0.728,0.729,0.730,0.731,0.732,0.733,0.734,0.735,0.736,0.737,0.738,0.739,0.740,0.741,0.741,0.742,0.743,0.744,0.745,0.746,0.747,0.748,0.749,0.749,0.750,0.751,0.752,0.753,0.754,0.755,0.755,0.756,0.757,0.758,0.759,0.759,0.760,0.761,0.762,0.763,0.763,0.764,0.765,0.766,0.767,0.767,0.768,0.769,0.770,0.770,0.771,0.772,0.773,0.773,0.774,0.775,0.775,0.776,0.777,0.778,0.778,0.779,0.780,0.780,0.781,0.782,0.782,0.783,0.784,0.784,0.785,0.786,0.786,0.787,0.788,0.788,0.789,0.790,0.790,0.791,0.791,0.792,0.793,0.793,0.794,0.795,0.795,0.796,0.796,0.797,0.798,0.798,0.799,0.799,0.800,0.800,0.801,0.802,0.802,0.803,0.803,0.804,0.804,0.805,0.806,0.806,0.807,0.807,0.808,0.808,0.809,0.809,0.810,0.810,0.811,0.812,0.812,0.813,0.813,0.814,0.814,0.815,0.815,0.816,0.816,0.817,0.817,0.818,0.818,0.819,0.819,0.820,0.820,0.821,0.821,0.821,0.822,0.822,0.823,0.823,0.824,0.824,0.825,0.825,0.826,0.826,0.827,0.827,0.827,0.828,0.828,0.829,0.829,0.830,0.830,0.831,0.831,0.831,0.832,0.832,0.833,0.833,0.834,0.834,0.834,0.835,0.835,0.836,0.836,0.836,0.837,0.837,0.838,0.838,0.838,0.839,0.839,0.840,0.840,0.840,0.841,0.841,0.842,0.842,0.842,0.843,0.843,0.843,0.844,0.844,0.845,0.845,0.845,0.846,0.846,0.846,0.847,0.847,0.848,0.848,0.848,0.849,0.849,0.849,0.850,0.850,0.850,0.851,0.851,0.851,0.852,0.852,0.852,0.853,0.853,0.853,0.854,0.854,0.854,0.855,0.855,0.855,0.856,0.856,0.856,0.857,0.857,0.857,0.858,0.858,0.858,0.859,0.859,0.859,0.860,0.860,0.860,0.860,0.861,0.861,0.861,0.862,0.862,0.862,0.863,0.863,0.863,0.863,0.864,0.864,0.864,0.865,0.865,0.865,0.865,0.866,0.866,0.866,0.867,0.867,0.867,0.867,0.868,0.868,0.868,0.869,0.869,0.869,0.869,0.870,0.870,0.870,0.870,0.871,0.871,0.871,0.872,0.872,0.872,0.872,0.873,0.873,0.873,0.873,0.874,0.874,0.874,0.874,0.875,0.875,0.875,0.875,0.876,0.876,0.876,0.876,0.877,0.877,0.877,0.877,0.878,0.878,0.878,0.878,0.879,0.879,0.879,0.879,0.880,0.880,0.880,0.880,0.880,0.881,0.881,0.881,0.881,0.882,0.882,0.882,0.882,0.883,0.883,0.883,0.883,0.883,0.884,0.884,0.884,0.884,0.885,0.885,0.885,0.885,0.885,0.886,0.886,0.886,0.886,0.886,0.887,0.887,0.887,0.887,0.887,0.888,0.888,0.888,0.888,0.889,0.889,0.889,0.889,0.889,0.890,0.890,0.890,0.890,0.890,0.891,0.891,0.891,0.891,0.891,0.892,0.892,0.892,0.892,0.892,0.892,0.893,0.893,0.893,0.893,0.893,0.894,0.894,0.894,0.894,0.894,0.895,0.895,0.895,0.895,0.895,0.895,0.896,0.896,0.896,0.896,0.896,0.897,0.897,0.897,0.897,0.897,0.897,0.898,0.898,0.898,0.898,0.898,0.898,0.899,0.899,0.899,0.899,0.899,0.900,0.900,0.900,0.900,0.900,0.900,0.901,0.901,0.901,0.901,0.901,0.901,0.902,0.902,0.902,0.902,0.902,0.902,0.902,0.903,0.903,0.903,0.903,0.903,0.903,0.904,0.904,0.904,0.904,0.904,0.904,0.905,0.905,0.905,0.905,0.905,0.905,0.905,0.906,0.906,0.906,0.906,0.906,0.906,0.907,0.907,0.907,0.907,0.907,0.907,0.907,0.908,0.908,0.908,0.908,0.908,0.908,0.908,0.909,0.909,0.909,0.909,0.909,0.909,0.909,0.910,0.910,0.910,0.910,0.910,0.910,0.910,0.911,0.911,0.911,0.911,0.911,0.911,0.911,0.911,0.912,0.912,0.912,0.912,0.912,0.912,0.912,0.913,0.913,0.913,0.913,0.913,0.913,0.913,0.913,0.914,0.914,0.914,0.914,0.914,0.914,0.914,0.914,0.915,0.915,0.915,0.915,0.915,0.915,0.915,0.915,0.916,0.916,0.916,0.916,0.916,0.916,0.916,0.916,0.917,0.917,0.917,0.917,0.917,0.917,0.917,0.917,0.918,0.918,0.918,0.918,0.918,0.918,0.918,0.918,0.919,0.919,0.919,0.919,0.919,0.919,0.919,0.919,0.919,0.920,0.920,0.920,0.920,0.920,0.920,0.920,0.920,0.920,0.921,0.921,0.921,0.921,0.921,0.921,0.921,0.921,0.921,0.922,0.922,0.922,0.922,0.922,0.922,0.922,0.922,0.922,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.939,0.939,0.939,0.939,0.939,0.939,0.939,0.939,0.939};
-float FastBlocksLimit[1050] = {317.772,136.233,83.194,58.732,44.894,36.089,30.038,25.646,22.327,19.739,17.669,15.980,14.577,13.396,12.389, 11.521,10.766,10.104,9.519,8.999,8.534,8.116,7.738,7.395,7.082,6.796,6.533,6.292,6.069,5.862,5.670,5.491,5.325,5.169,5.023,4.886,4.758,4.637,4.523,4.415,4.313,4.216,4.124,4.038,3.955,3.876,3.801,3.730,3.661,3.596,3.534,3.474,3.417,3.362,3.309,3.259,3.210,3.164,3.119,3.075,3.034,2.993,2.955,2.917,2.881,2.846,2.812,2.780,2.748,2.717,2.688,2.659,2.631,2.604,2.578,2.552,2.528,2.504,2.480,2.457,2.435,2.414,2.393,2.373,2.353,2.334,2.315,2.296,2.279,2.261,2.244,2.228,2.211,2.196,2.180,2.165,2.150,2.136,2.122,2.108,2.095,2.081,2.069,2.056,2.044,2.031,2.020,2.008,1.997,1.986,1.975,1.964,1.954,1.943,1.933,1.923,1.914,1.904,1.895,1.886,1.877,1.868,1.859,1.851,1.842,1.834,1.826,1.818,1.810,1.803,1.795,1.788,1.781,1.773,1.766,1.759,1.753,1.746,1.739,1.733,1.726,1.720,1.714,1.708,1.702,1.696,1.690,1.684,1.679,1.673,1.668,1.662,1.657,1.652,1.647,1.642,1.637,1.632,1.627,1.622,1.617,1.613,1.608,1.603,1.599,1.594,1.590,1.586,1.581,1.577,1.573,1.569,1.565,1.561,1.557,1.553,1.549,1.546,1.542,1.538,1.534,1.531,1.527,1.524,1.520,1.517,1.513,1.510,1.507,1.504,1.500,1.497,1.494,1.491,1.488,1.485,1.482,1.479,1.476,1.473,1.470,1.467,1.464,1.461,1.459,1.456,1.453,1.450,1.448,1.445,1.443,1.440,1.438,1.435,1.433,1.430,1.428,1.425,1.423,1.420,1.418,1.416,1.414,1.411,1.409,1.407,1.405,1.402,1.400,1.398,1.396,1.394,1.392,1.390,1.388,1.386,1.384,1.382,1.380,1.378,1.376,1.374,1.372,1.370,1.368,1.367,1.365,1.363,1.361,1.359,1.358,1.356,1.354,1.352,1.351,1.349,1.347,1.346,1.344,1.342,1.341,1.339,1.338,1.336,1.334,1.333,1.331,1.330,1.328,1.327,1.325,1.324,1.322,1.321,1.320,1.318,1.317,1.315,1.314,1.313,1.311,1.310,1.308,1.307,1.306,1.305,1.303,1.302,1.301,1.299,1.298,1.297,1.296,1.294,1.293,1.292,1.291,1.290,1.288,1.287,1.286,1.285,1.284,1.282,1.281,1.280,1.279,1.278,1.277,1.276,1.275,1.274,1.273,1.271,1.270,1.269,1.268,1.267,1.266,1.265,1.264,1.263,1.262,1.261,1.260,1.259,1.258,1.257,1.256,1.255,1.254,1.253,1.253,1.252,1.251,1.250,1.249,1.248,1.247,1.246,1.245,1.244,1.244,1.243,1.242,1.241,1.240,1.239,1.238,1.238,1.237,1.236,1.235,1.234,1.233,1.233,1.232,1.231,1.230,1.229,1.229,1.228,1.227,1.226,1.226,1.225,1.224,1.223,1.223,1.222,1.221,1.220,1.220,1.219,1.218,1.217,1.217,1.216,1.215,1.215,1.214,1.213,1.213,1.212,1.211,1.211,1.210,1.209,1.209,1.208,1.207,1.207,1.206,1.205,1.205,1.204,1.203,1.203,1.202,1.202,1.201,1.200,1.200,1.199,1.198,1.198,1.197,1.197,1.196,1.195,1.195,1.194,1.194,1.193,1.193,1.192,1.191,1.191,1.190,1.190,1.189,1.189,1.188,1.188,1.187,1.186,1.186,1.185,1.185,1.184,1.184,1.183,1.183,1.182,1.182,1.181,1.181,1.180,1.180,1.179,1.179,1.178,1.178,1.177,1.177,1.176,1.176,1.175,1.175,1.174,1.174,1.173,1.173,1.172,1.172,1.172,1.171,1.171,1.170,1.170,1.169,1.169,1.168,1.168,1.167,1.167,1.167,1.166,1.166,1.165,1.165,1.164,1.164,1.164,1.163,1.163,1.162,1.162,1.161,1.161,1.161,1.160,1.160,1.159,1.159,1.159,1.158,1.158,1.157,1.157,1.157,1.156,1.156,1.155,1.155,1.155,1.154,1.154,1.153,1.153,1.153,1.152,1.152,1.152,1.151,1.151,1.151,1.150,1.150,1.149,1.149,1.149,1.148,1.148,1.148,1.147,1.147,1.147,1.146,1.146,1.146,1.145,1.145,1.145,1.144,1.144,1.144,1.143,1.143,1.143,1.142,1.142,1.142,1.141,1.141,1.141,1.140,1.140,1.140,1.139,1.139,1.139,1.138,1.138,1.138,1.137,1.137,1.137,1.136,1.136,1.136,1.136,1.135,1.135,1.135,1.134,1.134,1.134,1.133,1.133,1.133,1.133,1.132,1.132,1.132,1.131,1.131,1.131,1.131,1.130,1.130,1.130,1.129,1.129,1.129,1.129,1.128,1.128,1.128,1.128,1.127,1.127,1.127,1.126,1.126,1.126,1.126,1.125,1.125,1.125,1.125,1.124,1.124,1.124,1.124,1.123,1.123,1.123,1.123,1.122,1.122,1.122,1.122,1.121,1.121,1.121,1.121,1.120,1.120,1.120,1.120,1.119,1.119,1.119,1.119,1.118,1.118,1.118,1.118,1.117,1.117,1.117,1.117,1.117,1.116,1.116,1.116,1.116,1.115,1.115,1.115,1.115,1.114,1.114,1.114,1.114,1.114,1.113,1.113,1.113,1.113,1.113,1.112,1.112,1.112,1.112,1.111,1.111,1.111,1.111,1.111,1.110,1.110,1.110,1.110,1.110,1.109,1.109,1.109,1.109,1.109,1.108,1.108,1.108,1.108,1.108,1.107,1.107,1.107,1.107,1.107,1.106,1.106,1.106,1.106,1.106,1.105,1.105,1.105,1.105,1.105,1.104,1.104,1.104,1.104,1.104,1.103,1.103,1.103,1.103,1.103,1.103,1.102,1.102,1.102,1.102,1.102,1.101,1.101,1.101,1.101,1.101,1.101,1.100,1.100,1.100,1.100,1.100,1.100,1.099,1.099,1.099,1.099,1.099,1.099,1.098,1.098,1.098,1.098,1.098,1.097,1.097,1.097,1.097,1.097,1.097,1.097,1.096,1.096,1.096,1.096,1.096,1.096,1.095,1.095,1.095,1.095,1.095,1.095,1.094,1.094,1.094,1.094,1.094,1.094,1.093,1.093,1.093,1.093,1.093,1.093,1.093,1.092,1.092,1.092,1.092,1.092,1.092,1.092,1.091,1.091,1.091,1.091,1.091,1.091,1.090,1.090,1.090,1.090,1.090,1.090,1.090,1.089,1.089,1.089,1.089,1.089,1.089,1.089,1.088,1.088,1.088,1.088,1.088,1.088,1.088,1.088,1.087,1.087,1.087,1.087,1.087,1.087,1.087,1.086,1.086,1.086,1.086,1.086,1.086,1.086,1.085,1.085,1.085,1.085,1.085,1.085,1.085,1.085,1.084,1.084,1.084,1.084,1.084,1.084,1.084,1.084,1.083,1.083,1.083,1.083,1.083,1.083,1.083,1.083,1.082,1.082,1.082,1.082,1.082,1.082,1.082,1.082,1.081,1.081,1.081,1.081,1.081,1.081,1.081,1.081,1.080,1.080,1.080,1.080,1.080,1.080,1.080,1.080,1.080,1.079,1.079,1.079,1.079,1.079,1.079,1.079,1.079,1.079,1.078,1.078,1.078,1.078,1.078,1.078,1.078,1.078,1.078,1.077,1.077,1.077,1.077,1.077,1.077,1.077,1.077,1.077,1.076,1.076,1.076,1.076,1.076,1.076,1.076,1.076,1.076,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.064,1.064,1.064,1.064,1.064,1.064,1.064};
+static const float SlowBlocksLimit[1050] = {0.00315,0.00734,0.0120,0.0170,0.0223,0.0277,0.0333,0.0380,0.0447,0.0507,0.0566,0.0626,0.0686,0.0746,0.0807,0.0868,0.0929,0.0980,0.105,0.111,0.117,0.123,0.129,0.135,0.141,0.147,0.153,0.158,0.164,0.170,0.176,0.182,0.187,0.193,0.199,0.204,0.210,0.215,0.221,0.226,0.231,0.237,0.242,0.247,0.252,0.257,0.263,0.268,0.273,0.278,0.282,0.287,0.292,0.297,0.302,0.306,0.311,0.316,0.320,0.325,0.329,0.334,0.338,0.342,0.347,0.351,0.355,0.359,0.363,0.367,0.372,0.376,0.380,0.383,0.387,0.391,0.395,0.399,0.403,0.406,0.410,0.414,0.417,0.421,0.424,0.428,0.431,0.435,0.438,0.442,0.445,0.448,0.452,0.455,0.458,0.461,0.464,0.468,0.471,0.474,0.477,0.480,0.483,0.486,0.489,0.492,0.495,0.497,0.500,0.503,0.506,0.509,0.511,0.514,0.517,0.519,0.522,0.525,0.527,0.530,0.532,0.535,0.537,0.540,0.542,0.545,0.547,0.549,0.552,0.554,0.556,0.559,0.561,0.563,0.565,0.568,0.570,0.572,0.574,0.576,0.579,0.581,0.583,0.585,0.587,0.589,0.591,0.593,0.595,0.597,0.599,0.601,0.603,0.605,0.607,0.608,0.610,0.612,0.614,0.616,0.618,0.619,0.621,0.623,0.625,0.626,0.628,0.630,0.632,0.633,0.635,0.637,0.638,0.640,0.642,0.643,0.645,0.646,0.648,0.649,0.651,0.653,0.654,0.656,0.657,0.659,0.660,0.661,0.663,0.664,0.666,0.667,0.669,0.670,0.671,0.673,0.674,0.676,0.677,0.678,0.680,0.681,0.682,0.684,0.685,0.686,0.687,0.689,0.690,0.691,0.692,0.694,0.695,0.696,0.697,0.699,0.700,0.701,0.702,0.703,0.704,0.706,0.707,0.708,0.709,0.710,0.711,0.712,0.713,0.714,0.716,0.717,0.718,0.719,0.720,0.721,0.722,0.723,0.724,0.725,0.726,0.727,0.728,0.729,0.730,0.731,0.732,0.733,0.734,0.735,0.736,0.737,0.738,0.739,0.740,0.741,0.741,0.742,0.743,0.744,0.745,0.746,0.747,0.748,0.749,0.749,0.750,0.751,0.752,0.753,0.754,0.755,0.755,0.756,0.757,0.758,0.759,0.759,0.760,0.761,0.762,0.763,0.763,0.764,0.765,0.766,0.767,0.767,0.768,0.769,0.770,0.770,0.771,0.772,0.773,0.773,0.774,0.775,0.775,0.776,0.777,0.778,0.778,0.779,0.780,0.780,0.781,0.782,0.782,0.783,0.784,0.784,0.785,0.786,0.786,0.787,0.788,0.788,0.789,0.790,0.790,0.791,0.791,0.792,0.793,0.793,0.794,0.795,0.795,0.796,0.796,0.797,0.798,0.798,0.799,0.799,0.800,0.800,0.801,0.802,0.802,0.803,0.803,0.804,0.804,0.805,0.806,0.806,0.807,0.807,0.808,0.808,0.809,0.809,0.810,0.810,0.811,0.812,0.812,0.813,0.813,0.814,0.814,0.815,0.815,0.816,0.816,0.817,0.817,0.818,0.818,0.819,0.819,0.820,0.820,0.821,0.821,0.821,0.822,0.822,0.823,0.823,0.824,0.824,0.825,0.825,0.826,0.826,0.827,0.827,0.827,0.828,0.828,0.829,0.829,0.830,0.830,0.831,0.831,0.831,0.832,0.832,0.833,0.833,0.834,0.834,0.834,0.835,0.835,0.836,0.836,0.836,0.837,0.837,0.838,0.838,0.838,0.839,0.839,0.840,0.840,0.840,0.841,0.841,0.842,0.842,0.842,0.843,0.843,0.843,0.844,0.844,0.845,0.845,0.845,0.846,0.846,0.846,0.847,0.847,0.848,0.848,0.848,0.849,0.849,0.849,0.850,0.850,0.850,0.851,0.851,0.851,0.852,0.852,0.852,0.853,0.853,0.853,0.854,0.854,0.854,0.855,0.855,0.855,0.856,0.856,0.856,0.857,0.857,0.857,0.858,0.858,0.858,0.859,0.859,0.859,0.860,0.860,0.860,0.860,0.861,0.861,0.861,0.862,0.862,0.862,0.863,0.863,0.863,0.863,0.864,0.864,0.864,0.865,0.865,0.865,0.865,0.866,0.866,0.866,0.867,0.867,0.867,0.867,0.868,0.868,0.868,0.869,0.869,0.869,0.869,0.870,0.870,0.870,0.870,0.871,0.871,0.871,0.872,0.872,0.872,0.872,0.873,0.873,0.873,0.873,0.874,0.874,0.874,0.874,0.875,0.875,0.875,0.875,0.876,0.876,0.876,0.876,0.877,0.877,0.877,0.877,0.878,0.878,0.878,0.878,0.879,0.879,0.879,0.879,0.880,0.880,0.880,0.880,0.880,0.881,0.881,0.881,0.881,0.882,0.882,0.882,0.882,0.883,0.883,0.883,0.883,0.883,0.884,0.884,0.884,0.884,0.885,0.885,0.885,0.885,0.885,0.886,0.886,0.886,0.886,0.886,0.887,0.887,0.887,0.887,0.887,0.888,0.888,0.888,0.888,0.889,0.889,0.889,0.889,0.889,0.890,0.890,0.890,0.890,0.890,0.891,0.891,0.891,0.891,0.891,0.892,0.892,0.892,0.892,0.892,0.892,0.893,0.893,0.893,0.893,0.893,0.894,0.894,0.894,0.894,0.894,0.895,0.895,0.895,0.895,0.895,0.895,0.896,0.896,0.896,0.896,0.896,0.897,0.897,0.897,0.897,0.897,0.897,0.898,0.898,0.898,0.898,0.898,0.898,0.899,0.899,0.899,0.899,0.899,0.900,0.900,0.900,0.900,0.900,0.900,0.901,0.901,0.901,0.901,0.901,0.901,0.902,0.902,0.902,0.902,0.902,0.902,0.902,0.903,0.903,0.903,0.903,0.903,0.903,0.904,0.904,0.904,0.904,0.904,0.904,0.905,0.905,0.905,0.905,0.905,0.905,0.905,0.906,0.906,0.906,0.906,0.906,0.906,0.907,0.907,0.907,0.907,0.907,0.907,0.907,0.908,0.908,0.908,0.908,0.908,0.908,0.908,0.909,0.909,0.909,0.909,0.909,0.909,0.909,0.910,0.910,0.910,0.910,0.910,0.910,0.910,0.911,0.911,0.911,0.911,0.911,0.911,0.911,0.911,0.912,0.912,0.912,0.912,0.912,0.912,0.912,0.913,0.913,0.913,0.913,0.913,0.913,0.913,0.913,0.914,0.914,0.914,0.914,0.914,0.914,0.914,0.914,0.915,0.915,0.915,0.915,0.915,0.915,0.915,0.915,0.916,0.916,0.916,0.916,0.916,0.916,0.916,0.916,0.917,0.917,0.917,0.917,0.917,0.917,0.917,0.917,0.918,0.918,0.918,0.918,0.918,0.918,0.918,0.918,0.919,0.919,0.919,0.919,0.919,0.919,0.919,0.919,0.919,0.920,0.920,0.920,0.920,0.920,0.920,0.920,0.920,0.920,0.921,0.921,0.921,0.921,0.921,0.921,0.921,0.921,0.921,0.922,0.922,0.922,0.922,0.922,0.922,0.922,0.922,0.922,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.923,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.924,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.925,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.926,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.927,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.928,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.929,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.930,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.931,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.932,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.933,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.934,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.935,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.936,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.937,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.938,0.939,0.939,0.939,0.939,0.939,0.939,0.939,0.939,0.939};
+static const float FastBlocksLimit[1050] = {317.772,136.233,83.194,58.732,44.894,36.089,30.038,25.646,22.327,19.739,17.669,15.980,14.577,13.396,12.389, 11.521,10.766,10.104,9.519,8.999,8.534,8.116,7.738,7.395,7.082,6.796,6.533,6.292,6.069,5.862,5.670,5.491,5.325,5.169,5.023,4.886,4.758,4.637,4.523,4.415,4.313,4.216,4.124,4.038,3.955,3.876,3.801,3.730,3.661,3.596,3.534,3.474,3.417,3.362,3.309,3.259,3.210,3.164,3.119,3.075,3.034,2.993,2.955,2.917,2.881,2.846,2.812,2.780,2.748,2.717,2.688,2.659,2.631,2.604,2.578,2.552,2.528,2.504,2.480,2.457,2.435,2.414,2.393,2.373,2.353,2.334,2.315,2.296,2.279,2.261,2.244,2.228,2.211,2.196,2.180,2.165,2.150,2.136,2.122,2.108,2.095,2.081,2.069,2.056,2.044,2.031,2.020,2.008,1.997,1.986,1.975,1.964,1.954,1.943,1.933,1.923,1.914,1.904,1.895,1.886,1.877,1.868,1.859,1.851,1.842,1.834,1.826,1.818,1.810,1.803,1.795,1.788,1.781,1.773,1.766,1.759,1.753,1.746,1.739,1.733,1.726,1.720,1.714,1.708,1.702,1.696,1.690,1.684,1.679,1.673,1.668,1.662,1.657,1.652,1.647,1.642,1.637,1.632,1.627,1.622,1.617,1.613,1.608,1.603,1.599,1.594,1.590,1.586,1.581,1.577,1.573,1.569,1.565,1.561,1.557,1.553,1.549,1.546,1.542,1.538,1.534,1.531,1.527,1.524,1.520,1.517,1.513,1.510,1.507,1.504,1.500,1.497,1.494,1.491,1.488,1.485,1.482,1.479,1.476,1.473,1.470,1.467,1.464,1.461,1.459,1.456,1.453,1.450,1.448,1.445,1.443,1.440,1.438,1.435,1.433,1.430,1.428,1.425,1.423,1.420,1.418,1.416,1.414,1.411,1.409,1.407,1.405,1.402,1.400,1.398,1.396,1.394,1.392,1.390,1.388,1.386,1.384,1.382,1.380,1.378,1.376,1.374,1.372,1.370,1.368,1.367,1.365,1.363,1.361,1.359,1.358,1.356,1.354,1.352,1.351,1.349,1.347,1.346,1.344,1.342,1.341,1.339,1.338,1.336,1.334,1.333,1.331,1.330,1.328,1.327,1.325,1.324,1.322,1.321,1.320,1.318,1.317,1.315,1.314,1.313,1.311,1.310,1.308,1.307,1.306,1.305,1.303,1.302,1.301,1.299,1.298,1.297,1.296,1.294,1.293,1.292,1.291,1.290,1.288,1.287,1.286,1.285,1.284,1.282,1.281,1.280,1.279,1.278,1.277,1.276,1.275,1.274,1.273,1.271,1.270,1.269,1.268,1.267,1.266,1.265,1.264,1.263,1.262,1.261,1.260,1.259,1.258,1.257,1.256,1.255,1.254,1.253,1.253,1.252,1.251,1.250,1.249,1.248,1.247,1.246,1.245,1.244,1.244,1.243,1.242,1.241,1.240,1.239,1.238,1.238,1.237,1.236,1.235,1.234,1.233,1.233,1.232,1.231,1.230,1.229,1.229,1.228,1.227,1.226,1.226,1.225,1.224,1.223,1.223,1.222,1.221,1.220,1.220,1.219,1.218,1.217,1.217,1.216,1.215,1.215,1.214,1.213,1.213,1.212,1.211,1.211,1.210,1.209,1.209,1.208,1.207,1.207,1.206,1.205,1.205,1.204,1.203,1.203,1.202,1.202,1.201,1.200,1.200,1.199,1.198,1.198,1.197,1.197,1.196,1.195,1.195,1.194,1.194,1.193,1.193,1.192,1.191,1.191,1.190,1.190,1.189,1.189,1.188,1.188,1.187,1.186,1.186,1.185,1.185,1.184,1.184,1.183,1.183,1.182,1.182,1.181,1.181,1.180,1.180,1.179,1.179,1.178,1.178,1.177,1.177,1.176,1.176,1.175,1.175,1.174,1.174,1.173,1.173,1.172,1.172,1.172,1.171,1.171,1.170,1.170,1.169,1.169,1.168,1.168,1.167,1.167,1.167,1.166,1.166,1.165,1.165,1.164,1.164,1.164,1.163,1.163,1.162,1.162,1.161,1.161,1.161,1.160,1.160,1.159,1.159,1.159,1.158,1.158,1.157,1.157,1.157,1.156,1.156,1.155,1.155,1.155,1.154,1.154,1.153,1.153,1.153,1.152,1.152,1.152,1.151,1.151,1.151,1.150,1.150,1.149,1.149,1.149,1.148,1.148,1.148,1.147,1.147,1.147,1.146,1.146,1.146,1.145,1.145,1.145,1.144,1.144,1.144,1.143,1.143,1.143,1.142,1.142,1.142,1.141,1.141,1.141,1.140,1.140,1.140,1.139,1.139,1.139,1.138,1.138,1.138,1.137,1.137,1.137,1.136,1.136,1.136,1.136,1.135,1.135,1.135,1.134,1.134,1.134,1.133,1.133,1.133,1.133,1.132,1.132,1.132,1.131,1.131,1.131,1.131,1.130,1.130,1.130,1.129,1.129,1.129,1.129,1.128,1.128,1.128,1.128,1.127,1.127,1.127,1.126,1.126,1.126,1.126,1.125,1.125,1.125,1.125,1.124,1.124,1.124,1.124,1.123,1.123,1.123,1.123,1.122,1.122,1.122,1.122,1.121,1.121,1.121,1.121,1.120,1.120,1.120,1.120,1.119,1.119,1.119,1.119,1.118,1.118,1.118,1.118,1.117,1.117,1.117,1.117,1.117,1.116,1.116,1.116,1.116,1.115,1.115,1.115,1.115,1.114,1.114,1.114,1.114,1.114,1.113,1.113,1.113,1.113,1.113,1.112,1.112,1.112,1.112,1.111,1.111,1.111,1.111,1.111,1.110,1.110,1.110,1.110,1.110,1.109,1.109,1.109,1.109,1.109,1.108,1.108,1.108,1.108,1.108,1.107,1.107,1.107,1.107,1.107,1.106,1.106,1.106,1.106,1.106,1.105,1.105,1.105,1.105,1.105,1.104,1.104,1.104,1.104,1.104,1.103,1.103,1.103,1.103,1.103,1.103,1.102,1.102,1.102,1.102,1.102,1.101,1.101,1.101,1.101,1.101,1.101,1.100,1.100,1.100,1.100,1.100,1.100,1.099,1.099,1.099,1.099,1.099,1.099,1.098,1.098,1.098,1.098,1.098,1.097,1.097,1.097,1.097,1.097,1.097,1.097,1.096,1.096,1.096,1.096,1.096,1.096,1.095,1.095,1.095,1.095,1.095,1.095,1.094,1.094,1.094,1.094,1.094,1.094,1.093,1.093,1.093,1.093,1.093,1.093,1.093,1.092,1.092,1.092,1.092,1.092,1.092,1.092,1.091,1.091,1.091,1.091,1.091,1.091,1.090,1.090,1.090,1.090,1.090,1.090,1.090,1.089,1.089,1.089,1.089,1.089,1.089,1.089,1.088,1.088,1.088,1.088,1.088,1.088,1.088,1.088,1.087,1.087,1.087,1.087,1.087,1.087,1.087,1.086,1.086,1.086,1.086,1.086,1.086,1.086,1.085,1.085,1.085,1.085,1.085,1.085,1.085,1.085,1.084,1.084,1.084,1.084,1.084,1.084,1.084,1.084,1.083,1.083,1.083,1.083,1.083,1.083,1.083,1.083,1.082,1.082,1.082,1.082,1.082,1.082,1.082,1.082,1.081,1.081,1.081,1.081,1.081,1.081,1.081,1.081,1.080,1.080,1.080,1.080,1.080,1.080,1.080,1.080,1.080,1.079,1.079,1.079,1.079,1.079,1.079,1.079,1.079,1.079,1.078,1.078,1.078,1.078,1.078,1.078,1.078,1.078,1.078,1.077,1.077,1.077,1.077,1.077,1.077,1.077,1.077,1.077,1.076,1.076,1.076,1.076,1.076,1.076,1.076,1.076,1.076,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.075,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.074,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.073,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.072,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.071,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.070,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.069,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.068,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.067,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.066,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.065,1.064,1.064,1.064,1.064,1.064,1.064,1.064};
 		
 	int64_t  L(0), next_D, i, N=uN, T=uT;
 	int64_t target=0, tarPrev=0, tarAvg=0, j=0, ActualTimespan=0, TargetTimespan=0;
@@ -436,11 +517,64 @@ float FastBlocksLimit[1050] = {317.772,136.233,83.194,58.732,44.894,36.089,30.03
 	else {next_D = cumulative_difficulties[N] - cumulative_difficulties[N-1]; }
 	return next_D;
 }
+// ==============================================
+//  =========	O(1) STATE DAs  =================
+// ==============================================
+/* EMA_, EMA3_, ASERT_ and ETH_ only use the previous block's D and solvetime, so these take just that. The window 
+versions below call them, and the simulation uses them without a window, so a chain of one of these DAs is a few 
+words (o1_state). ETH_'s previous timestamp is the "safe" one: out-of-sequence timestamps are moved to 1 second after
+the one before, so it has to be carried along with the chain. ETH_'s window version can't see that far back and starts
+again from timestamps.front()-T, so it gets a lower safe timestamp (and a higher D) when every timestamp in its window
+is at or before the carried one, like after a run of N equal timestamps. EMA_, EMA3_ and ASERT_ are the same either
+way. o1_check compares them. */
+u EMA_next(u prev_D, u prev_timestamp, u timestamp, u T, u N) {
+	u ST = timestamp - prev_timestamp;
+	return (prev_D*N*10000)/(10000*N+10000*ST/T-10000);	
+}
+u EMA3_next(u prev_D, u prev_timestamp, u timestamp, u T, u N) {
+	//  (1+1/N+k*(k/2-1-1/2/N))
+	//  (2*T*N*T*N+2*T*T*N+t*(t-2*T*N-T))/(N*T*N*T*2)
+	u ST = timestamp - prev_timestamp;
+	return (prev_D *(2*T*N*T*N+2*T*T*N+ST*(ST-2*T*N-T)))/(N*T*N*T*2); // JE accurate
+}
+u ASERT_next(u prev_D, u prev_timestamp, u timestamp, u T, u M) {
+	u ST = timestamp - prev_timestamp;
+	u exp_A = exponential_function_for_integers((1E6)/M);
+	u exp_B = exponential_function_for_integers((ST*1E6)/M/T);
+	return u (prev_D*exp_A/exp_B);
+}
+u ETH_safe_timestamp(u prev_safe_timestamp, u timestamp) {
+	return timestamp <= prev_safe_timestamp ? prev_safe_timestamp+1 : timestamp;
+}
+u ETH_next(u prev_D, u prev_safe_timestamp, u timestamp, u T, u N) {
+	u ST = std::max(static_cast<u>(1), ETH_safe_timestamp(prev_safe_timestamp, timestamp) - prev_safe_timestamp);
+	return u (prev_D*N/(N+(1443*ST/T)/1000-1)); // 1443/1000 = 1/ln(2)
+}
+// 0 if DA isn't one of them, so the string compares are done once and not every block.
+enum { O1_EMA = 1, O1_EMA3, O1_ASERT, O1_ETH };
+int o1_DA(const string& DA) { 
+	return DA == "EMA_" ? O1_EMA : DA == "EMA3_" ? O1_EMA3 : DA == "ASERT_" ? O1_ASERT : DA == "ETH_" ? O1_ETH : 0; 
+}
+
+// A chain of an O(1) DA. prev_timestamp is ETH_'s safe one. 
+struct o1_state {
+	u D, prev_timestamp, timestamp;
+	u next_D(int DA, u T, u N, u M) const {
+		if (DA == O1_EMA) { return EMA_next(D, prev_timestamp, timestamp, T, N); }
+		if (DA == O1_EMA3) { return EMA3_next(D, prev_timestamp, timestamp, T, N); }
+		if (DA == O1_ASERT) { return ASERT_next(D, prev_timestamp, timestamp, T, M); }
+		return ETH_next(D, prev_timestamp, timestamp, T, N);
+	}
+	void add_block(int DA, u D_, u timestamp_) {
+		prev_timestamp = DA == O1_ETH ? ETH_safe_timestamp(prev_timestamp, timestamp) : timestamp;
+		D = D_; timestamp = timestamp_;
+	}
+};
 // ==============================
 // ==========	EMA	===========  Tom's basic form with forced sequential timestamps
 // ==============================
-u EMA_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u EMA_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT, u  difficulty_guess) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -448,26 +582,13 @@ u EMA_(std::vector<u> timestamps,
 	// Hard code D if there are not at least N+1 BLOCKS after fork (or genesis)
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
 	assert(timestamps.size() == N+1); 
-		
-	u previous_timestamp(0), this_timestamp(0), ST;
-	 // Safely handle out-of-sequence timestamps
-	// This is awkward because N defines a window of timestamps to review while EMA uses only previous timestamp
-	previous_timestamp = 0;
-	for (int i = 0; i < timestamps.size(); i++) {	// changing 0 to 1 causes problem??
-		if ( timestamps[i] <= previous_timestamp ) { this_timestamp = previous_timestamp; } 
-		else { this_timestamp = timestamps[i]; }
-		ST = this_timestamp - previous_timestamp; 
-		previous_timestamp = this_timestamp; 
-	}
-	 ST = (timestamps[N] - timestamps[N-1]);
-	u prev_D = (cumulative_difficulties[N] - cumulative_difficulties[N-1]);
-	return (prev_D*N*10000)/(10000*N+10000*ST/T-10000);	
+	return EMA_next(cumulative_difficulties[N] - cumulative_difficulties[N-1], timestamps[N-1], timestamps[N], T, N);
 }
 // ==============================
 // ==========	EMA3 (JE accurate)  Most precise version that does not have problems
 // ==============================	other than potential overflow which is easier to fix in targets.
-u EMA3_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u EMA3_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u  difficulty_guess) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -476,17 +597,13 @@ u EMA3_(std::vector<u> timestamps,
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
 	assert(timestamps.size() == N+1); 
 	
-	//  (1+1/N+k*(k/2-1-1/2/N))
-	//  (2*T*N*T*N+2*T*T*N+t*(t-2*T*N-T))/(N*T*N*T*2)
-	u ST = timestamps[N] - timestamps[N-1];
-	u prev_D = cumulative_difficulties[N] - cumulative_difficulties[N-1];
-	return (prev_D *(2*T*N*T*N+2*T*T*N+ST*(ST-2*T*N-T)))/(N*T*N*T*2); // JE accurate
+	return EMA3_next(cumulative_difficulties[N] - cumulative_difficulties[N-1], timestamps[N-1], timestamps[N], T, N);
 }
 // =============================== This is the EMA perfected. Due to the way my exp() is used,
 // ========  ASERT  ============== it does not have the error in usage that EMA did unles N>400 ish
 // ===============================
-u ASERT_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
+u ASERT_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u  difficulty_guess, u M) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -495,17 +612,14 @@ u ASERT_(std::vector<u> timestamps,
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
 	assert(timestamps.size() == N+1); 
 
-	u ST = timestamps[N] - timestamps[N-1] ;
-	u exp_A = exponential_function_for_integers((1E6)/M);
-	u exp_B = exponential_function_for_integers((ST*1E6)/M/T);
-	return u (cumulative_difficulties[N]-cumulative_difficulties[N-1])*exp_A/exp_B;
+	return ASERT_next(cumulative_difficulties[N]-cumulative_difficulties[N-1], timestamps[N-1], timestamps[N], T, M);
 }
 // =============================== 
 // ========  ASERT_SMA  ==========
 // ===============================
-u ASERT_SMA_(std::vector<u> timestamps, 
-	std::vector<u> cumulative_difficulties, u T, u N, u height,
-					u FORK_HEIGHT,u  difficulty_guess, u M) {
+u ASERT_SMA_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
+					u FORK_HEIGHT,u  difficulty_guess, u M, u anchor_timestamp, u anchor_D) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
 
@@ -513,9 +627,9 @@ u ASERT_SMA_(std::vector<u> timestamps,
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
 	assert(timestamps.size() == N+1); 
 	
-	u ST = (timestamps[N] - START_TIMESTAMP -(height-FORK_HEIGHT+2)*T) ;
-	if (timestamps[N] < START_TIMESTAMP + (height-FORK_HEIGHT+2)*T) {
-		ST = START_TIMESTAMP + (height-FORK_HEIGHT+2)*T - timestamps[N];
+	u ST = (timestamps[N] - anchor_timestamp -(height-FORK_HEIGHT+2)*T) ;
+	if (timestamps[N] < anchor_timestamp + (height-FORK_HEIGHT+2)*T) {
+		ST = anchor_timestamp + (height-FORK_HEIGHT+2)*T - timestamps[N];
 	}
 	u exp_A = exponential_function_for_integers(1e6/M);
 	u exp_B = exponential_function_for_integers((ST*1E6)/T/M);
@@ -527,15 +641,55 @@ u ASERT_SMA_(std::vector<u> timestamps,
 	*/
 	// tar = 1e13/(cumulative_difficulties[N-M]-cumulative_difficulties[N-M-1]);
 	// return u (cumulative_difficulties[N]-cumulative_difficulties[0])/N*exp_A/exp_B;
-	if (timestamps[N] < START_TIMESTAMP + (height-FORK_HEIGHT+2)*T) {
-		return BASELINE_D*exp_A*exp_B/10000/10000;
+	if (timestamps[N] < anchor_timestamp + (height-FORK_HEIGHT+2)*T) {
+		return anchor_D*exp_A*exp_B/10000/10000;
 	}
-	else {	return BASELINE_D*exp_A/exp_B;	}
+	else {	return anchor_D*exp_A/exp_B;	}
+}
+// =============================== 
+// ========  ASERTI3  ============ BCH's aserti3-2d: absolute ASERT_SMA_ in integers on targets
+// =============================== 
+// exponential_function_for_integers() stops at e^17 and does ~12 64-bit divisions. This is 2^x instead of e^x with 
+// x in 1/65536ths: a shift for the integer part and a cubic for 2^(frac/65536)*65536. The cubic is within 0.013% of it.
+u ASERTI3_2_to_frac(u frac) {
+	return 65536 + ((195766423245049ULL*frac + 971821376ULL*frac*frac + 5127ULL*frac*frac*frac + (1ULL << 47)) >> 48);
+}
+// target = anchor_target * 2^((time_diff - T*(height_diff+1))/halflife), between 1 and pow_limit. 
+// anchor_target*2^17 has to fit in 256 bits.
+uint256 ASERTI3_target(const uint256& anchor_target, int64_t time_diff, int64_t height_diff, u T, u halflife, 
+					const uint256& pow_limit) {
+	int64_t exponent = ((time_diff - int64_t(T)*(height_diff+1))*65536)/int64_t(halflife);
+	int64_t shifts = (exponent >> 16) - 16; // >> of a negative rounds down with gcc and clang
+	uint256 target = anchor_target*ASERTI3_2_to_frac(u(exponent & 0xffff));
+	if (shifts <= 0) { target >>= u(-shifts); }
+	else if (shifts >= 256 || target.bits() + shifts > 256) { target = pow_limit; }
+	else { target <<= u(shifts); }
+	if (target == 0) { return 1; }
+	return target > pow_limit ? pow_limit : target;
+}
+// Same time constant as ASERT_ and ASERT_SMA_'s e^(t/M/T): halflife = ln(2)*M*T
+u ASERTI3_halflife(u T, u M) { return std::max(u(1), M*T*693147/1000000); }
+
+u ASERTI3_(const std::vector<u>& timestamps, 
+	const std::vector<u>& cumulative_difficulties, u T, u N, u height,
+					u FORK_HEIGHT,u  difficulty_guess, u M, u anchor_timestamp, u anchor_D) {
+	// Genesis should be the only time sizes are < N+1.
+	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
+
+	// Hard code D if there are not at least N+1 BLOCKS after fork (or genesis)
+	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
+	assert(timestamps.size() == N+1); 
+
+	// Anchored like ASERT_SMA_, whose e^(1/M) is the +2. Targets are 2^224/D so a target*2^17 fits.
+	uint256 pow_limit = uint256(1) << 224;
+	uint256 D = pow_limit/ASERTI3_target(pow_limit/anchor_D, int64_t(timestamps[N] - anchor_timestamp), 
+		int64_t(height - FORK_HEIGHT + 2), T, ASERTI3_halflife(T, M), pow_limit);
+	return D.bits() > 62 ? u(1) << 62 : D.GetLow64();
 }
 // =============================
 // ========  ETH  ==============
 // =============================
-u ETH_(std::vector<u> timestamps,	 std::vector<u> cumulative_difficulties, u T, u N, u height,
+u ETH_(const std::vector<u>& timestamps,	 const std::vector<u>& cumulative_difficulties, u T, u N, u height,
 					u FORK_HEIGHT,u  difficulty_guess) {
 	// Genesis should be the only time sizes are < N+1.
 	assert(timestamps.size() == cumulative_difficulties.size() && timestamps.size() <= N+1 );
@@ -544,55 +698,751 @@ u ETH_(std::vector<u> timestamps,	 std::vector<u> cumulative_difficulties, u T,
 	if (height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1) { return difficulty_guess; }
 	assert(timestamps.size() == N+1); 
 	
-	u previous_timestamp(0), this_timestamp(0), ST;
 	 // Safely handle out-of-sequence timestamps
 	// This is awkward because N defines a window of timestamps to review but 
-	// EMA only uses previous timestamp
-	previous_timestamp = timestamps.front()- T;
-	for ( int i = 0; i < timestamps.size(); i++) {
- 		if ( timestamps[i] <= previous_timestamp ) { this_timestamp = previous_timestamp+1; } 
- 		else { this_timestamp = timestamps[i]; }
-		ST = std::max(static_cast<u>(1),this_timestamp - previous_timestamp);
- 		previous_timestamp = this_timestamp; 
+	// EMA only uses previous timestamp. The chain's carried safe timestamp (o1_state) can be higher than this.
+	u previous_timestamp = timestamps.front()- T;
+	for ( int i = 0; i < N; i++) { previous_timestamp = ETH_safe_timestamp(previous_timestamp, timestamps[i]); }
+	return ETH_next(cumulative_difficulties[N]-cumulative_difficulties[N-1], previous_timestamp, timestamps[N], T, N);
+}
+// ===============================================
+// ========  RT_CST_RST  (see difficulty_jump.h)
+// ===============================================
+// The baseline DA is DIGISHIELD_improved_ because difficulty_jump.h says MTP=1 if using Digishield. 
+// The target then depends on the solvetime t the miner selects. With S = sum of the W targets:
+// state 1: target = S*min(1, t/tc) where tc = T*T*num/den/span.   state 2: target = S*span*t/W/W/T/T.
+// Targets are 2^256/D. The solvetime is where the integral of HR*target(t)/2^256/DX reaches -ln(rand).
+u RT_CST_RST_solvetime(const RT_CST_RST_tracker& rt, u baseline_D, float neg_log_rand, u HR, u T, u DX) {
+	const RT_CST_RST_tracker::window* x = rt.active();
+	if (!x) { return static_cast<u>(neg_log_rand*baseline_D*DX/HR); }
+	double c = double(HR)/DX/pow(2,256);
+	double S = x->sum_targets.getdouble(), span = std::max(static_cast<u>(1), x->span), t;
+	if (x->state == 1) {
+		double tc = double(T)*T*x->numerator/x->denominator/span;
+		if (neg_log_rand <= c*S*tc/2) { t = sqrt(2*neg_log_rand*tc/c/S); }
+		else { t = tc + (neg_log_rand - c*S*tc/2)/c/S; }
 	}
-	return u ((cumulative_difficulties[N]-cumulative_difficulties[N-1])*N/(N+(1443*ST/T)/1000-1)); // 1443/1000 = 1/ln(2)
+	else { t = sqrt(2*neg_log_rand*x->W*x->W*T*T/c/S/span); }
+	return std::max(static_cast<u>(1), static_cast<u>(0.5+t));
+}
+// What the tracker adds to its cumulative targets for a block with difficulty D and solvetime ST. Per the Update note
+// in difficulty_jump.h it's not the target on chain but target*ST^2*1000/784/T/T. Divided first so it fits in 2^256.
+uint256 RT_CST_RST_ct(u D, u ST, u T) { return (~uint256(0))/std::max(u(1), D)/(784*T*T)*ST*ST*1000; }
+// Difficulty on chain for a block solved at nTime.
+u RT_CST_RST_D(const RT_CST_RST_tracker& rt, u baseline_D, u nTime) {
+	uint256 target = rt.next_target((~uint256(0))/std::max(u(1), baseline_D), nTime);
+	if (target == 0) { target = 1; }
+	return static_cast<u>(std::min(1e18, pow(2,256)/target.getdouble()));
 }
 // ==============================================
-//  =========	RUN SIMULATION  =================
+//  =========	RUN DA  =========================
+// ==============================================
+// The DAs that only need the N+1 timestamp and cumulative difficulty window. This is the interface
+// replay and the other tools use. M is the extra parameter for LWMA_ASERT_, ASERT_, ASERT_SMA_ and ASERTI3_.
+vector<string> WINDOW_DAS = { "SMA_", "SMS_", "DGW_", "DIGISHIELD_", "DIGISHIELD_improved_", "LWMA1_", "LWMA4_", 
+	"WHR_", "LWMA_ASERT_", "KGW_", "EMA_", "EMA3_", "ETH_", "ASERT_", "ASERT_SMA_", "ASERTI3_" };
+
+// anchor_timestamp and anchor_D are the fork (or genesis) block's, for the DAs anchored there.
+u run_DA(const string& DA, const vector<u>& TS, const vector<u>& CD, u T, u N, u height, u fork_height, 
+					u difficulty_guess, u M, u anchor_timestamp, u anchor_D) {
+	if (DA == "LWMA1_" ) {	return LWMA1_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	if (DA == "LWMA4_" ) {	return LWMA4_(TS,CD,T,N,height,fork_height, difficulty_guess);  }
+	if (DA == "WHR_" ) {	return WHR_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	if (DA == "KGW_" || DA == "Boris_" ) {	return Boris_(TS,CD,T,N,height,fork_height, difficulty_guess);  }
+	if (DA == "DIGISHIELD_" ) { return DIGISHIELD_(TS,CD,T,N, height, fork_height, difficulty_guess);  }  
+	if (DA == "DIGISHIELD_improved_" ) { return DIGISHIELD_improved_(TS,CD,T,N,height,fork_height, difficulty_guess);  } 
+	if (DA == "SMA_" ) {	return SMA_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	if (DA == "SMS_" ) {	return SMS_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	if (DA == "EMA_" ) {	return EMA_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	if (DA == "EMA3_" ) {	return EMA3_(TS,CD,T,N, height, fork_height, difficulty_guess);  }  
+	if (DA == "ETH_" ) {	return ETH_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	if (DA == "LWMA_ASERT_" ) {	return LWMA_ASERT_(TS,CD,T,N, height, fork_height, difficulty_guess, M);  }
+	if (DA == "ASERT_" || DA == "ASERT_RTT_" ) {	return ASERT_(TS,CD,T,N, height, fork_height, difficulty_guess, M);  } 
+	if (DA == "ASERT_SMA_" ) {	return ASERT_SMA_(TS,CD,T,N, height, fork_height, difficulty_guess, M, anchor_timestamp, anchor_D);  }
+	if (DA == "ASERTI3_" ) {	return ASERTI3_(TS,CD,T,N, height, fork_height, difficulty_guess, M, anchor_timestamp, anchor_D);  }
+	if (DA == "DGW_" ) {	return DGW_(TS,CD,T,N, height, fork_height, difficulty_guess);  }
+	return 0;
+}
+// ==============================================
+//  =========	RTT SOLVETIME SAMPLER  ==========
 // ==============================================
+/* With real-time targeting the difficulty depends on how long the block has taken so far: D(t) = D0*shape(t). Hashes
+find the block at a rate of HR/(D(t)*DX), so the solvetime is the t where the integrated hazard, HR/(D0*DX) * G(t) with
+G(t) = integral of 1/shape from 0 to t, equals NEG_LOG_RAND[i] (an exponential random variable). For a constant D 
+that's the usual NEG_LOG_RAND[i]*D*DX/HR. A shape can register the inverse of G when it has a closed form. Otherwise
+G is tabulated once per simulation and each draw is a binary search plus a few Newton steps, so any RTT design can be 
+simulated without deriving anything.  */
+
+struct rtt_shape {
+	double (*shape)(double t, const double* p);	// D(t)/D0
+	double (*inverse_G)(double y, const double* p);	// the t where G(t) = y, or 0 if there's no closed form
+	double p[2];
+};
+double constant_shape(double, const double*) { return 1; }
+double constant_inverse_G(double y, const double*) { return y; }
+// TSA_ with template_timestamp: D0*M/(M-1+t/T), p = {M, T}
+double TSA_shape(double t, const double* p) { return p[0]/(p[0]-1+t/p[1]); }
+double TSA_inverse_G(double y, const double* p) { 
+	return p[1]*(sqrt((p[0]-1)*(p[0]-1) + 2*p[0]*y/p[1]) - (p[0]-1)); 
+}
+// ASERT_ with the template's timestamp as the newest one: D0*e^(1/M)/e^(t/M/T), p = {M, T}
+double ASERT_RTT_shape(double t, const double* p) { return exp((1 - t/p[1])/p[0]); }
+double ASERT_RTT_inverse_G(double y, const double* p) { return p[0]*p[1]*log(1 + y*exp(1/p[0])/p[0]/p[1]); }
+
+rtt_shape rtt_shape_for(const string& DA, u T, u M, bool closed_form = true) {
+	rtt_shape s = { constant_shape, constant_inverse_G, {double(M), double(T)} };
+	if (DA == "TSA_") { s.shape = TSA_shape; s.inverse_G = TSA_inverse_G; }
+	if (DA == "ASERT_RTT_") { s.shape = ASERT_RTT_shape; s.inverse_G = ASERT_RTT_inverse_G; }
+	if (!closed_form) { s.inverse_G = 0; }
+	return s;
+}
 
-int run_simulation(string DA, u T, u N,u difficulty_guess,u baseline_HR,u attack_start,u attack_stop,u attack_size, u R) {
+class rtt_sampler {
+public:
+	rtt_sampler(const rtt_shape& s_, double t_max, u points = 4096) : s(s_), h(t_max/points) {
+		if (s.inverse_G) { return; }
+		G.resize(points+1);
+		G[0] = 0;
+		for (u j = 0; j < points; j++) { G[j+1] = G[j] + integral(j*h, (j+1)*h); }
+	}
+	// Same arguments as simulate_ST().
+	double solvetime(double D0, u DX, double HR, double neg_log_rand) const {
+		double y = neg_log_rand*D0*DX/HR;
+		if (s.inverse_G) { return s.inverse_G(y, s.p); }
+		// Find the table interval, or walk past the end of the table.
+		u j = upper_bound(G.begin(), G.end(), y) - G.begin() - 1;
+		double a = j*h, Ga = G[j];
+		while (j+1 == G.size() && Ga + integral(a, a+h) < y) { Ga += integral(a, a+h); a += h; }
+		// Newton on Ga + integral(a,t) = y. G' = 1/shape.
+		double t = a + (f(a) > 0 ? (y - Ga)/f(a) : h/2);
+		for (int k = 0; k < 8; k++) {
+			double e = Ga + integral(a, t) - y;
+			t = std::max(a, t - e/f(t));
+			if (fabs(e) <= 1e-10*y) { break; }
+		}
+		return t;
+	}
+private:
+	rtt_shape s;
+	double h;
+	vector<double> G;
+	double f(double t) const { return 1/s.shape(t, s.p); }
+	double integral(double a, double b) const { return (b-a)/6*(f(a) + 4*f((a+b)/2) + f(b)); } // Simpson
+};
+
+// Compare the tabulated inverse with the closed forms and time them.
+int rtt_sampler_check(u draws) {
+	u T = 600, errors = 0;
+	vector<double> x(draws);
+	for (u i = 0; i < draws; i++) { x[i] = log(1/fRand(0.000001,0.999999)); }
+	cout << "DA\t\tM\tmax rel diff\tclosed ns\ttable ns" << endl;
+	string DAs[2] = {"TSA_", "ASERT_RTT_"};
+	for (int a = 0; a < 2; a++) {
+		for (u M = 1; M <= 64; M *= 4) {
+			if (DAs[a] == "TSA_" && M == 1) { continue; }
+			rtt_sampler closed(rtt_shape_for(DAs[a], T, M), 20*T), table(rtt_shape_for(DAs[a], T, M, false), 20*T);
+			double max_diff = 0, sum = 0, D0 = 1e6, HR = D0/T;
+			auto start = chrono::steady_clock::now();
+			for (u i = 0; i < draws; i++) { sum += closed.solvetime(D0, 1, HR, x[i]); }
+			auto middle = chrono::steady_clock::now();
+			for (u i = 0; i < draws; i++) { sum += table.solvetime(D0, 1, HR, x[i]); }
+			auto end = chrono::steady_clock::now();
+			for (u i = 0; i < draws; i++) {
+				double c = closed.solvetime(D0, 1, HR, x[i]);
+				max_diff = std::max(max_diff, fabs(table.solvetime(D0, 1, HR, x[i]) - c)/c);
+			}
+			if (max_diff > 1e-6) { errors++; }
+			cout << DAs[a] << (DAs[a].size() < 8 ? "\t\t" : "\t") << M << "\t" << max_diff << "\t" << 
+				chrono::duration<double, nano>(middle-start).count()/draws << "\t\t" << 
+				chrono::duration<double, nano>(end-middle).count()/draws << (sum < 0 ? " " : "") << endl;
+		}
+	}
+	return errors > 0;
+}
+// ASERTI3_'s 2^x against pow() for every fraction and over the whole target range, then the time per block of ASERT_, 
+// ASERT_SMA_ and ASERTI3_ with M = 80, and how far exponential_function_for_integers() is from exp() up to e^25.
+// The kernel line is ASERT_next() and ASERTI3_target(), which is ASERTI3_ on a chain's targets without the 256 bit
+// divides between D and targets. ASERT_SMA_ has no kernel apart from its window function.
+int asert_check(u draws) {
+	u T = 600, M = 80, N = 10, halflife = ASERTI3_halflife(T, M), errors = 0;
+	double max_frac = 0, max_target = 0;
+	for (u f = 0; f < 65536; f++) { max_frac = std::max(max_frac, fabs(ASERTI3_2_to_frac(f)/pow(2, f/65536.0)/65536 - 1)); }
+	// Exponents from below target 1 to above pow_limit. Under 2^40 it's the integer rounding that's off.
+	uint256 pow_limit = uint256(1) << 224, anchor = pow_limit/10000;
+	u clamped = 0;
+	for (u i = 0; i < draws; i++) {
+		int64_t height_diff = fRand(0, 1e7), time_diff = int64_t(T)*(height_diff+1) + int64_t(fRand(-230, 30)*halflife);
+		uint256 t = ASERTI3_target(anchor, time_diff, height_diff, T, halflife, pow_limit);
+		double x = ((time_diff - int64_t(T)*(height_diff+1))*65536/int64_t(halflife))/65536.0;
+		double exact = anchor.getdouble()*pow(2, x);
+		if (exact < 1 || exact >= pow_limit.getdouble()) { 
+			clamped++; 
+			// Within the 2^x error of pow_limit it can go either way.
+			double expected = exact < 1 ? 1 : pow_limit.getdouble();
+			if (fabs(t.getdouble()/expected - 1) > 0.00015) { errors++; }
+		}
+		else if (exact > pow(2, 40)) { max_target = std::max(max_target, fabs(t.getdouble()/exact - 1)); }
+	}
+	if (max_frac > 0.00015 || max_target > 0.00015) { errors++; }
+	cout << "ASERTI3_ 2^x max rel error: " << max_frac << " for all 65536 fractions, " << max_target << " for " << 
+		draws - clamped << " targets from 2^40 to pow_limit. " << clamped << " clamped to 1 or pow_limit, " << errors << 
+		" wrong." << endl;
+
+	u fork_height = 0, anchor_timestamp = 1540000000, anchor_D = 1e4, sink = 0;
+	vector<vector<u>> TS(1000, vector<u>(N+1)), CD(1000, vector<u>(N+1));
+	vector<u> heights(1000);
+	for (u k = 0; k < 1000; k++) {
+		heights[k] = N+2 + u(fRand(0, 1e6));
+		TS[k][N] = anchor_timestamp + (heights[k]+3)*T + int64_t(fRand(-5, 5)*halflife);
+		for (u j = N; j > 0; j--) { TS[k][j-1] = TS[k][j] - u(fRand(1, 3*T)); }
+		for (u j = 0; j <= N; j++) { CD[k][j] = (j+1)*u(fRand(5000, 20000)); }
+	}
+	double max_diff = 0;
+	for (u k = 0; k < 1000; k++) {
+		double a = ASERT_SMA_(TS[k], CD[k], T, N, heights[k], fork_height, anchor_D, M, anchor_timestamp, anchor_D);
+		double b = ASERTI3_(TS[k], CD[k], T, N, heights[k], fork_height, anchor_D, M, anchor_timestamp, anchor_D);
+		max_diff = std::max(max_diff, fabs(b/a - 1));
+	}
+	cout << "ASERTI3_ vs ASERT_SMA_ max rel diff within +/-5 half lives: " << max_diff << endl;
+	double ns[5] = {0};
+	for (int a = 0; a < 5; a++) {
+		auto start = chrono::steady_clock::now();
+		for (u i = 0; i < draws; i++) { 
+			const vector<u>& ts = TS[i % 1000];
+			const vector<u>& cd = CD[i % 1000];
+			u h = heights[i % 1000];
+			if (a == 0) { sink += ASERT_(ts, cd, T, N, h, fork_height, anchor_D, M); }
+			else if (a == 1) { sink += ASERT_SMA_(ts, cd, T, N, h, fork_height, anchor_D, M, anchor_timestamp, anchor_D); }
+			else if (a == 2) { sink += ASERTI3_(ts, cd, T, N, h, fork_height, anchor_D, M, anchor_timestamp, anchor_D); }
+			else if (a == 3) { sink += ASERT_next(cd[N]-cd[N-1], ts[N-1], ts[N], T, M); }
+			else { sink += ASERTI3_target(anchor, int64_t(ts[N] - anchor_timestamp), h+2, T, halflife, pow_limit).pn[2]; }
+		}
+		ns[a] = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count()/draws;
+	}
+	cout << "ns per block\tASERT_\tASERT_SMA_\tASERTI3_" << endl;
+	cout << "DA\t\t" << ns[0] << "\t" << ns[1] << "\t\t" << ns[2] << endl;
+	cout << "kernel\t\t" << ns[3] << "\t" << ns[1] << "\t\t" << ns[4] << endl;
+	cout << "x\texponential_function_for_integers(x*1E6)/10000/e^x - 1" << endl;
+	for (u x = 0; x <= 25; x++) {
+		double e = 0;
+		for (u f = 0; f < 1000; f++) { 
+			e = std::max(e, fabs(exponential_function_for_integers(x*1000000 + f*1000)/1e4/exp(x + f/1000.0) - 1)); 
+		}
+		cout << x << "\t" << e << (sink == 1 ? " " : "") << endl;
+	}
+	return errors > 0;
+}
+/* The O(1) state DAs' window versions against o1_state on the same chain, with 1 in 5 timestamps equal to the one 
+before. ETH_'s chain also has 1 in 10 up to 3T before it (the others don't handle out-of-sequence timestamps). EMA_, 
+EMA3_ and ASERT_ have to match every block. ETH_'s window can only differ when all N of its timestamps before the last
+are at or below the carried safe timestamp minus how many blocks they are from the end, so that's what's checked. */
+int o1_check(u T, u N, u M, u blocks) {
+	const string DAs[4] = { "EMA_", "EMA3_", "ASERT_", "ETH_" };
+	u errors = 0;
+	cout << "DA	blocks	differ	max rel diff	wrong" << endl;
+	for (int DA = O1_EMA; DA <= O1_ETH; DA++) {
+		u D0 = 1e6, HR = D0/T, now = 1540000000, differ = 0, wrong = 0;
+		vector<u> TS, CD;
+		for (u i = 0; i <= N; i++) { TS.push_back(now + i*T); CD.push_back((i+1)*D0); }
+		now = TS[N];
+		o1_state st = { D0, TS[N-1], TS[N] };
+		double max_diff = 0;
+		for (u i = 0; i < blocks; i++) {
+			u a = st.next_D(DA, T, N, M), b = run_DA(DAs[DA-1], TS, CD, T, N, N+2+i, 0, D0, M, 0, 0);
+			if (a != b) { 
+				differ++; 
+				max_diff = std::max(max_diff, fabs(double(b)/a - 1));
+				bool explained = DA == O1_ETH;
+				for (u k = 0; k < N; k++) { if (TS[k] + N-1-k >= st.prev_timestamp) { explained = false; } }
+				if (!explained) { wrong++; }
+			}
+			now += u(log(1/fRand(0.000001,0.999999))*a/HR);
+			double r = fRand(0, 1);
+			u t = r < 0.2 ? TS.back() : DA == O1_ETH && r < 0.3 ? TS.back() - u(fRand(0, 3*T)) : now;
+			st.add_block(DA, a, t);
+			TS.erase(TS.begin()); CD.erase(CD.begin());
+			TS.push_back(t); CD.push_back(CD.back() + a);
+		}
+		errors += wrong;
+		cout << DAs[DA-1] << "\t" << blocks << "\t" << differ << "\t" << max_diff << "\t\t" << wrong << endl;
+	}
+	return errors > 0;
+}
+// ==============================================
+//  =========	LOG HISTOGRAMS  =================
+// ==============================================
+/* HDR-style log-linear histogram. Values below 2^LOG_HIST_BITS get a bucket each, and each power of 2 above that is 
+cut into 2^(LOG_HIST_BITS-1) equal buckets, so no bucket is wider than 1/128 of its values and a value is reported as 
+its bucket's middle within 0.4%, from 1 to 2^64. record() is a count leading zeros, a shift and an add. The buckets 
+are only allocated up to the largest value, so solvetimes up to 100T are about 10 KB. Doubles are recorded as x*scale 
+rounded, so with a scale of 1000 normalized difficulties keep 3 decimals below 0.256 and 0.4% above. Nothing is
+shared: each thread records into its own and merge() adds them after, so the result doesn't depend on how the work was
+split. compact() is "scale total buckets index:count ..." for the nonzero buckets. */
+const int LOG_HIST_BITS = 8;
+struct log_histogram {
+	double scale;
+	u total = 0;
+	vector<u> counts;
+	explicit log_histogram(double scale_ = 1) : scale(scale_) {}
+
+	static u index(u v) {
+		if (v < (u(1) << LOG_HIST_BITS)) { return v; }
+		int b = 64 - LOG_HIST_BITS - __builtin_clzll(v); // v >> b has LOG_HIST_BITS bits
+		return (u(b) << (LOG_HIST_BITS-1)) + (v >> b);
+	}
+	// The lowest value in bucket i, and how many values it has.
+	static u lowest(u i) {
+		u half = u(1) << (LOG_HIST_BITS-1);
+		return i < 2*half ? i : (i % half + half) << (i/half - 1);
+	}
+	static u width(u i) { return i < (u(2) << (LOG_HIST_BITS-1)) ? 1 : u(1) << (i/(u(1) << (LOG_HIST_BITS-1)) - 1); }
+
+	void record(double x) { double v = x*scale + 0.5; record_scaled(v < 1 ? 0 : v >= 1.8e19 ? ~u(0) : u(v)); }
+	// A value that's already x*scale, like a solvetime with scale 1.
+	void record_scaled(u v) {
+		u i = index(v);
+		if (i >= counts.size()) { counts.resize(i+1, 0); }
+		counts[i]++; total++;
+	}
+	void merge(const log_histogram& h) {
+		assert(scale == h.scale);
+		if (h.counts.size() > counts.size()) { counts.resize(h.counts.size(), 0); }
+		for (u i = 0; i < h.counts.size(); i++) { counts[i] += h.counts[i]; }
+		total += h.total;
+	}
+	// The value p% of the records are at or below (p = 50, 99, 99.99), as its bucket's middle.
+	double percentile(double p) const {
+		u rank = std::max(u(1), u(ceil(p/100*total))), seen = 0;
+		for (u i = 0; i < counts.size(); i++) {
+			seen += counts[i];
+			if (seen >= rank) { return (lowest(i) + (width(i)-1)/2.0)/scale; }
+		}
+		return 0;
+	}
+	string percentiles() const { 
+		ostringstream s; 
+		s << percentile(50) << "/" << percentile(99) << "/" << percentile(99.99); 
+		return s.str(); 
+	}
+	string compact() const {
+		ostringstream s;
+		u n = 0;
+		for (u c : counts) { n += c > 0; }
+		s << scale << " " << total << " " << n;
+		for (u i = 0; i < counts.size(); i++) { if (counts[i]) { s << " " << i << ":" << counts[i]; } }
+		return s.str();
+	}
+	bool parse(istream& f) {
+		u n = 0;
+		f >> scale >> total >> n;
+		counts.clear();
+		for (u k = 0; f && k < n; k++) {
+			u i = 0, c = 0;
+			char colon = 0;
+			f >> i >> colon >> c;
+			if (colon != ':' || i > index(~u(0))) { return false; }
+			if (i >= counts.size()) { counts.resize(i+1, 0); }
+			counts[i] = c;
+		}
+		return bool(f);
+	}
+};
 
+// ==============================================
+//  =========	PROGRESS TELEMETRY  =============
+// ==============================================
+/* Progress of sweeps, checkpoint runs and replicas while they run. Each worker thread has its own counters on their
+own cache lines: blocks of the jobs it finished, the jobs, the blocks of cached jobs it skipped, and how far the job
+it's on has gotten, which simulation::run() stores every 4096 blocks. They're relaxed atomics that only the worker 
+writes, so the hot loop never waits on anything. A reporter thread reads them every PROGRESS_SECONDS and prints a 
+status line to cerr (so the tables on cout are the same), and if STATUS_FILE is set rewrites it as JSON (every 10 s if
+there's no status line) by writing a .tmp and renaming it, so a dashboard never reads half of one. blocks/s is over the last interval and the ETA uses the
+rate since the reporter's first sample, so blocks a checkpoint run resumed from don't count as fast ones. */
+double PROGRESS_SECONDS(10); // --progress seconds, 0 for none
+string STATUS_FILE; // --status file.json
+const u PROGRESS_EVERY = 4096; // blocks, a power of 2
+
+// 128 bytes so that 2 workers' counters are never on the same cache line however the vector is aligned.
+struct telemetry_worker {
+	atomic<u> blocks, jobs, skipped, current;
+	char pad[128 - 4*sizeof(atomic<u>)];
+	telemetry_worker() : blocks(0), jobs(0), skipped(0), current(0) { }
+	void add(atomic<u>& x, u n) { x.store(x.load(memory_order_relaxed) + n, memory_order_relaxed); }
+	void job_done(u n) { add(blocks, n); current.store(0, memory_order_relaxed); add(jobs, 1); }
+	void job_skipped(u n) { add(skipped, n); add(jobs, 1); }
+};
+thread_local telemetry_worker* TELEMETRY_WORKER = 0; // the calling thread's, if something is reporting on it
+
+class telemetry {
+public:
+	telemetry(const string& what, u workers, u jobs, u blocks) : name(what), w(workers), total_jobs(jobs), 
+		total_blocks(blocks), start(chrono::steady_clock::now()) {
+		if (PROGRESS_SECONDS > 0 || !STATUS_FILE.empty()) { reporter = thread(&telemetry::report_loop, this); }
+	}
+	~telemetry() {
+		{ lock_guard<mutex> lock(m); stopping = true; }
+		wake.notify_one();
+		if (reporter.joinable()) { reporter.join(); report(true); }
+		TELEMETRY_WORKER = 0;
+	}
+	// Call in worker thread t before its jobs.
+	telemetry_worker& attach(u t) { TELEMETRY_WORKER = &w[t]; return w[t]; }
+private:
+	string name;
+	vector<telemetry_worker> w;
+	u total_jobs, total_blocks, first_done = 0, last_done = 0;
+	double first_seconds = -1, last_seconds = 0, rate = 0;
+	chrono::steady_clock::time_point start;
+	thread reporter;
+	mutex m;
+	condition_variable wake;
+	bool stopping = false;
+
+	void report_loop() {
+		unique_lock<mutex> lock(m);
+		double interval = PROGRESS_SECONDS > 0 ? PROGRESS_SECONDS : 10;
+		while (!wake.wait_for(lock, chrono::duration<double>(interval), [this] { return stopping; })) { report(false); }
+	}
+	void report(bool done) {
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		u blocks = 0, jobs = 0, skipped = 0;
+		for (const telemetry_worker& x : w) {
+			blocks += x.blocks.load(memory_order_relaxed) + x.current.load(memory_order_relaxed);
+			jobs += x.jobs.load(memory_order_relaxed); skipped += x.skipped.load(memory_order_relaxed);
+		}
+		if (seconds > last_seconds) { rate = (blocks - last_done)/(seconds - last_seconds); }
+		if (first_seconds < 0) { first_seconds = seconds; first_done = blocks; }
+		last_done = blocks; last_seconds = seconds;
+		double avg_rate = seconds > first_seconds ? (blocks - first_done)/(seconds - first_seconds) : 0;
+		if (done) { rate = avg_rate > 0 ? avg_rate : blocks/std::max(seconds, 1e-9); }
+		u left = total_blocks > blocks + skipped ? total_blocks - blocks - skipped : 0;
+		double eta = done ? 0 : avg_rate > 0 ? left/avg_rate : -1;
+		if (PROGRESS_SECONDS > 0 && !done) {
+			char line[200];
+			snprintf(line, sizeof(line), "%s: %llu/%llu jobs, %.4g/%.4g blocks, %.3g blocks/s, %.0f s, ETA %s", 
+				name.c_str(), (unsigned long long)jobs, (unsigned long long)total_jobs, double(blocks + skipped), 
+				double(total_blocks), rate, seconds, eta < 0 ? "?" : (to_string(u(eta + 0.5)) + " s").c_str());
+			cerr << line << endl;
+		}
+		if (STATUS_FILE.empty()) { return; }
+		string tmp = STATUS_FILE + ".tmp";
+		{
+			ofstream f(tmp);
+			f << "{\"what\": \"" << name << "\", \"state\": \"" << (done ? "done" : "running") << "\", \"pid\": " << 
+				getpid() << ", \"updated\": " << time(0) << ", \"seconds\": " << seconds << ", \"jobs\": " << jobs << 
+				", \"total_jobs\": " << total_jobs << ", \"blocks\": " << blocks << ", \"cached_blocks\": " << skipped << 
+				", \"total_blocks\": " << total_blocks << ", \"blocks_per_second\": " << rate << ", \"eta_seconds\": " << 
+				eta << ", \"workers\": [";
+			for (u t = 0; t < w.size(); t++) {
+				f << (t ? ", " : "") << "{\"blocks\": " << w[t].blocks.load(memory_order_relaxed) + 
+					w[t].current.load(memory_order_relaxed) << ", \"jobs\": " << w[t].jobs.load(memory_order_relaxed) << "}";
+			}
+			f << "]}" << endl;
+			if (!f) { remove(tmp.c_str()); return; }
+		}
+		rename(tmp.c_str(), STATUS_FILE.c_str());
+	}
+};
 
-cout << DA << " blocks to simulate: " << BLOCKS << ". Baseline Diff: " << BASELINE_D << ". Target timespan: " << T << 
-". Start/stop (attacks size) as multiples of baseline difficulty (hashrate): " << float(attack_start)/100 << " / " << 
-float(attack_stop)/100 << " (" << float(attack_size)/100 << ")" << endl;
+// ==============================================
+//  =========	RUN SIMULATION  =================
+// ==============================================
 
-// R is used for EMA and TSA
+// Where run_simulation()'s time goes with -DPHASE_TIMING. DA includes TSA_'s and RT_CST_RST_'s solvetimes because 
+// they're done inside it, and bookkeeping is the attack, hashrate, per-block arrays and sums.
+enum { PH_SETUP, PH_DA, PH_SOLVETIME, PH_WINDOW, PH_BOOKKEEPING, PH_CHECKPOINT, PH_METRICS, PH_FILES, PH_GNUPLOT, PHASES };
+const char* const PHASE_NAMES[PHASES] = { "setup", "DA", "solvetime", "window", "bookkeeping", "checkpoint", "metrics", 
+	"files", "gnuplot" };
+
+// A simulation's result: what run_simulation() prints, without rounding. delays and stolen are in %. blocks is how 
+// many it ran, and the _hw are the 95% half widths from batch means if it ran with a precision_target. The rest are 
+// for run_simulation()'s printing and plots. TWA_D is the time-weighted average D.
+struct sim_metrics { 
+	double avgST, avgD, SD_D, SD_ST, delays, stolen, avgST_hw, stolen_hw, delays_hw; u blocks; 
+	double avgHR, avgDtsa, TWA_D; u attack_blocks;
+};
+
+// Approximate 95% quantile of the t distribution with n-1 degrees of freedom, times the standard error.
+double half_width_95(double variance, u n) { return (1.96 + 2.37/(n-1))*sqrt(std::max(0.0, variance)/n); }
+double half_width_95(const vector<double>& x) {
+	if (x.size() < 2) { return 1e300; }
+	double m = 0, v = 0;
+	for (double y : x) { m += y; }
+	m /= x.size();
+	for (double y : x) { v += (y-m)*(y-m); }
+	return half_width_95(v/(x.size()-1), x.size());
+}
+/* Stop run_simulation() once the 95% confidence intervals are this narrow (0 = no target). After the 2N block 
+burn-in the blocks are cut into batches, each batch gives one value of each metric, and the interval comes from those 
+batch means. Batches need to be a lot longer than N so they're nearly independent. A batch with no attack blocks has
+no "stolen" value.  */
+struct precision_target {
+	double avgST_pct, stolen, delays;	// avg ST in % of avg ST, the others in percentage points
+	u batch, min_batches;
+	bool met(const vector<double>& ST, const vector<double>& st, const vector<double>& dl, double& ST_hw, 
+			double& st_hw, double& dl_hw) const {
+		if (ST.size() < min_batches) { return false; }
+		double m = 0;
+		for (double y : ST) { m += y; }
+		m /= ST.size();
+		ST_hw = 100*half_width_95(ST)/m; st_hw = half_width_95(st); dl_hw = half_width_95(dl);
+		return (!avgST_pct || ST_hw <= avgST_pct) && (!stolen || st_hw <= stolen) && (!delays || dl_hw <= delays);
+	}
+};
+
+/* The simulation as a library. Everything a run needs is in sim_config and everything it changes is in the simulation,
+so runs don't share state and can be on different threads. The per-block buffers are allocated when a simulation is
+made, so run() allocates nothing in the block loop (except once to fill in a snapshot, and for checkpoints). A 
+simulation can run() again to reuse its buffers, like with another snapshot or after the draws it points to were 
+changed. The draws are shared read-only if the config points to them, otherwise the simulation makes its own from 
+seed. ASERT_SMA_ and ASERTI3_ are anchored to the config's start_timestamp and baseline_D. run_simulation() is the 
+client main() and the tools use: it copies the globals into a sim_config and prints and plots the results. */
+struct sim_config {
+	string DA = "LWMA1_";
+	u T = 600, N = 60, M = 0;	// M is R in run_simulation()
+	u blocks = 20000;
+	u baseline_D = 1e4, difficulty_guess = 0, baseline_HR = 0; // 0 = baseline_D and baseline_D*dx/T
+	u fork_height = 0, start_timestamp = 1540000000, start_cd = 1E9, dx = 1;
+	bool cn_delay = false;
+	u attack_start = 130, attack_stop = 135, attack_size = 800; // see main()
+	const vector<float>* draws = 0;	// NEG_LOG_RAND values, at least blocks of them, or 0 to make them from seed
+	uint64_t seed = 1;
+	const hashrate_profile* profile = 0; // 0 = constant
+	const precision_target* stop = 0;
+};
+
+/* A run's state after its 2N block burn-in, so later runs can start there instead of at a made-up fork window, and 
+every block they simulate counts. run_simulation() fills in an empty snapshot at block 2N and starts a run from a full 
+one at block 2N+1 if it was made with the same DA settings. Block i still uses NEG_LOG_RAND[i], so with the same draws 
+a warm run is exactly the rest of the cold run, and with new draws (another seed) it's a new run from a steady state. 
+Runs with other attack settings can start from it too, but the window came from the attack it was made with, so make 
+those with attack_size = 100. RT_CST_RST_'s tracker is rebuilt from its last 64 blocks, which is all it remembers. */
+struct sim_snapshot {
+	string DA;
+	u T = 0, N = 0, M = 0, baseline_D = 0, dx = 0, fork_height = 0, start_timestamp = 0, start_cd = 0, cn_delay = 0;
+	u start = 0; // first block to simulate, 0 = empty
+	u next_D = 0, attack_on = 0, previous_ST = 0;
+	vector<u> TS, CD, STs;	// STs are the 11 blocks before start, for the 11 block delays metric
+	vector<u> rt_TS, rt_D;	// the RT_CST_RST_tracker's last blocks
+	// N is the simulation's window(), with DIGISHIELD_'s 6.
+	bool matches(const sim_config& c, u N_) const {
+		return start && DA == c.DA && T == c.T && N == N_ && M == c.M && baseline_D == c.baseline_D && dx == c.dx && 
+			fork_height == c.fork_height && start_timestamp == c.start_timestamp && start_cd == c.start_cd && 
+			cn_delay == c.cn_delay;
+	}
+};
+const u SNAPSHOT_RT_BLOCKS = 64; // RT_CST_RST_tracker's past + W_max + 2
+
+bool save_snapshot(const sim_snapshot& s, const string& path) {
+	ofstream f(path);
+	f << "DASNAP1 " << s.DA << " " << s.T << " " << s.N << " " << s.M << " " << s.baseline_D << " " << s.dx << " " << 
+		s.fork_height << " " << s.start_timestamp << " " << s.start_cd << " " << s.cn_delay << " " << s.start << " " << 
+		s.next_D << " " << s.attack_on << " " << s.previous_ST << endl;
+	for (const vector<u>* v : {&s.TS, &s.CD, &s.STs, &s.rt_TS, &s.rt_D}) {
+		f << v->size();
+		for (u x : *v) { f << " " << x; }
+		f << endl;
+	}
+	return bool(f);
+}
+bool load_snapshot(sim_snapshot& s, const string& path) {
+	ifstream f(path);
+	string magic;
+	f >> magic >> s.DA >> s.T >> s.N >> s.M >> s.baseline_D >> s.dx >> s.fork_height >> s.start_timestamp >> 
+		s.start_cd >> s.cn_delay >> s.start >> s.next_D >> s.attack_on >> s.previous_ST;
+	if (!f || magic != "DASNAP1") { cout << path << " is not a snapshot." << endl; return false; }
+	for (vector<u>* v : {&s.TS, &s.CD, &s.STs, &s.rt_TS, &s.rt_D}) {
+		u n = 0;
+		f >> n;
+		v->resize(n);
+		for (u& x : *v) { f >> x; }
+	}
+	if (!f) { cout << path << " is truncated." << endl; return false; }
+	return true;
+}
 
-if ( DA == "DIGISHIELD_" ) { N=N+6; } // For simulated MTP = 11 delay.
+/* Checkpoints, so a long run that's stopped can go on where it was. Every "every" blocks run() saves what it has after
+that block: the DA window, next_D and the attack state, the sums and batch means so far, and the next block, which is
+also the RNG position because block i always uses draw i (the draws have to be the same, so make them from a seed).
+The metrics at the end are done from every block's solvetime, difficulty and hashrate, so those are appended to 
+path.blocks, and the state replaces path by writing path.tmp and renaming it, so a kill leaves the last whole 
+checkpoint. Blocks don't change after they're simulated, so a thread writes them and the state while the run goes on,
+and the run only stops if the last checkpoint isn't written yet. A run() with resume starts from path if it was saved
+with the same key and gives exactly what the run would have if it wasn't stopped. RT_CST_RST_'s tracker is rebuilt 
+from its last 64 blocks like a snapshot's. */
+struct sim_checkpoint {
+	string path, key;	// key is the run's settings and seed, like sweep_key()
+	u every = 1000000;
+	bool resume = false;
+	// run() fills these in.
+	u written = 0, resumed_at = 0;
+	double wait_ms = 0, write_ms = 0; // time the run stopped for checkpoints, and the thread's time writing them
+};
+const char CHECKPOINT_MAGIC[8] = "DACKPT1";
+
+// Checkpoint bytes: numbers as they are in memory, vectors and strings as their size then their elements.
+struct bin_writer {
+	string s;
+	template <typename X> void put(const X& x) { s.append((const char*)&x, sizeof(x)); }
+	template <typename X> void put(const vector<X>& v) { put(u(v.size())); s.append((const char*)v.data(), v.size()*sizeof(X)); }
+	void put(const string& x) { put(u(x.size())); s += x; }
+};
+struct bin_reader {
+	const string& s;
+	size_t at = 0;
+	bool ok = true;
+	explicit bin_reader(const string& s_) : s(s_) {}
+	bool take(void* p, size_t n) { 
+		if (!ok || n > s.size()-at) { ok = false; return false; } 
+		memcpy(p, s.data()+at, n); at += n; return true; 
+	}
+	template <typename X> void get(X& x) { take(&x, sizeof(x)); }
+	template <typename X> void get(vector<X>& v) { 
+		u n = 0; get(n); 
+		if (ok && n <= (s.size()-at)/sizeof(X)) { v.resize(n); take(v.data(), n*sizeof(X)); } else { ok = false; }
+	}
+	void get(string& x) { vector<char> v; get(v); x.assign(v.begin(), v.end()); }
+};
+
+bool write_all(int fd, const char* p, size_t n) {
+	while (n) {
+		ssize_t k = write(fd, p, n);
+		if (k <= 0) { return false; }
+		p += k; n -= k;
+	}
+	return true;
+}
+// A checkpoint block: solvetime, difficulty, hashrate, TSA_'s difficulty.
+const u CHECKPOINT_BLOCK_BYTES = 3*sizeof(u) + sizeof(float);
+
+// Appends blocks [from, to) to path.blocks, then replaces path with state.
+bool write_checkpoint(const string& path, const string& state, const u* STs, const u* Ds, const u* HRs, 
+		const float* Dtsa, u from, u to) {
+	int fd = open((path + ".blocks").c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (fd < 0) { return false; }
+	vector<char> buf(4096*CHECKPOINT_BLOCK_BYTES);
+	bool ok = true;
+	for (u a = from; ok && a < to; a += 4096) {
+		u b = std::min(to, a+4096);
+		char* p = buf.data();
+		for (u k = a; k < b; k++) {
+			memcpy(p, &STs[k], 8); memcpy(p+8, &Ds[k], 8); memcpy(p+16, &HRs[k], 8); memcpy(p+24, &Dtsa[k], 4);
+			p += CHECKPOINT_BLOCK_BYTES;
+		}
+		ok = write_all(fd, buf.data(), p - buf.data());
+	}
+	ok = ok && fdatasync(fd) == 0;
+	close(fd);
+	if (!ok) { return false; }
+	string tmp = path + ".tmp";
+	fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) { return false; }
+	ok = write_all(fd, CHECKPOINT_MAGIC, 8) && write_all(fd, state.data(), state.size()) && fdatasync(fd) == 0;
+	close(fd);
+	return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+bool read_checkpoint_state(const string& path, string& state) {
+	ifstream f(path, ios::binary);
+	char magic[8] = {0};
+	f.read(magic, 8);
+	if (!f || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0) { return false; }
+	state.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+	return true;
+}
+// Blocks [0, start) from path.blocks, which is cut there in case a checkpoint after it didn't finish.
+bool read_checkpoint_blocks(const string& path, u start, u* STs, u* Ds, u* HRs, float* Dtsa) {
+	string blocks = path + ".blocks";
+	int fd = open(blocks.c_str(), O_RDONLY);
+	if (fd < 0) { return false; }
+	vector<char> buf(4096*CHECKPOINT_BLOCK_BYTES);
+	bool ok = true;
+	for (u a = 0; ok && a < start; a += 4096) {
+		u b = std::min(start, a+4096);
+		size_t n = (b-a)*CHECKPOINT_BLOCK_BYTES;
+		ok = read(fd, buf.data(), n) == ssize_t(n);
+		const char* p = buf.data();
+		for (u k = a; ok && k < b; k++) {
+			memcpy(&STs[k], p, 8); memcpy(&Ds[k], p+8, 8); memcpy(&HRs[k], p+16, 8); memcpy(&Dtsa[k], p+24, 4);
+			p += CHECKPOINT_BLOCK_BYTES;
+		}
+	}
+	close(fd);
+	return ok && truncate(blocks.c_str(), start*CHECKPOINT_BLOCK_BYTES) == 0;
+}
 
+class simulation {
+public:
+	explicit simulation(const sim_config& config) : c(config), N(config.N), 
+			sampler(rtt_shape_for(config.DA, config.T, config.M), 20*config.T), rt(config.T) {
+		if (c.DA == "DIGISHIELD_") { N = N+6; } // For simulated MTP = 11 delay.
+		if (!c.difficulty_guess) { c.difficulty_guess = c.baseline_D; }
+		if (!c.baseline_HR) { c.baseline_HR = std::max(u(1), c.baseline_D*c.dx/c.T); }
+		// TSA_ can't simulate ST with CN_delay because it depends on a per-block ST & D connection. 
+		cn_delay = c.cn_delay && c.DA != "TSA_" && c.DA != "RT_CST_RST_";
+		o1 = o1_DA(c.DA); // these keep o1_state instead of the TS and CD window
+		if (!c.draws) {
+			mt19937_64 rng(c.seed);
+			uniform_real_distribution<float> U(0.000001, 0.999999);
+			own_draws.resize(c.blocks);
+			for (float& x : own_draws) { x = log(1/U(rng)); }
+			c.draws = &own_draws;
+		}
+		STs.resize(c.blocks); Ds.resize(c.blocks); HRs.resize(c.blocks); Dtsa.resize(c.blocks);
+		if (!o1) { TS.reserve(N+3); CD.reserve(N+3); }
+		if (c.DA == "RT_CST_RST_") { rt_TS.reserve(3*N+3); rt_D.reserve(3*N+3); }
+		if (c.stop) { for (auto v : {&batch_ST, &batch_stolen, &batch_delays}) { v->reserve(c.blocks/c.stop->batch + 1); } }
+	}
+	const sim_metrics& run(sim_snapshot* snapshot = 0, sim_checkpoint* checkpoint = 0);
+
+	const sim_config& config() const { return c; }
+	u window() const { return N; } // N + DIGISHIELD_'s 6
+	u first_block() const { return first; } // 2N+1 if it started from a snapshot
+	// Per block, the first result().blocks of them.
+	const vector<u>& solvetimes() const { return STs; }
+	const vector<u>& difficulties() const { return Ds; }
+	const vector<u>& hashrates() const { return HRs; }
+	const vector<float>& TSA_difficulties() const { return Dtsa; } // TSA_ only
+	const sim_metrics& result() const { return r; }
+	double run_ms() const { return ms; }
+
+private:
+	sim_config c;
+	u N, first = 0;
+	bool cn_delay;
+	int o1;
+	o1_state st;
+	vector<float> own_draws;
+	vector<u> STs, Ds, HRs, TS, CD, rt_TS, rt_D;
+	vector<float> Dtsa;	// TSA will be the only 1 to change the all-0 values
+	vector<double> batch_ST, batch_stolen, batch_delays;
+	rtt_sampler sampler;
+	RT_CST_RST_tracker rt;
+	sim_metrics r;
+	double ms = 0;
+};
+
+const sim_metrics& simulation::run(sim_snapshot* snapshot, sim_checkpoint* checkpoint) {
 	// In theory, this just uses ST = -ln(rand())* T * D/HR, but it's a mess, half-way because of CN_delay.
 	// I should have made two different methods.  One with CN delay and one without.
 	// Even without that it would have been a mess because of genesis or fork option.  Needed 4 methods.
-
-	u next_D(0), TSA_D, simulated_ST(0), i, HR(0), attack_on(0);
+	const string& DA = c.DA;
+	const vector<float>& NEG_LOG_RAND = *c.draws;
+	u T = c.T, R = c.M, baseline_HR = c.baseline_HR, BASELINE_D = c.baseline_D, FORK_HEIGHT = c.fork_height;
+	u next_D(0), TSA_D(0), simulated_ST(0), i, HR(0), attack_on(0);
 	u previous_ST, current_ST;
-	vector<u>STs(BLOCKS);
-	vector<u>Ds(BLOCKS);
-	vector<u>HRs(BLOCKS);
-	vector<float>Dtsa(BLOCKS,0); // TSA will be the only 1 to change the all-0 values
+	fill(Dtsa.begin(), Dtsa.end(), 0);
 
 	// Initially assume it's genesis
-	vector<u>TS(1);
-	TS[0] = START_TIMESTAMP;
-
-	vector<u>CD(1);
-	CD[0] = START_CD; 
+	TS.assign(1, c.start_timestamp);
+	CD.assign(1, c.start_cd);
 
+	if (o1) { 
+		// The last of the blocks made up below.
+		u last = c.start_timestamp + (FORK_HEIGHT >= N+1 ? N*T : FORK_HEIGHT == 0 ? T : 0);
+		st.D = BASELINE_D; st.prev_timestamp = last - T; st.timestamp = last;
+	}
 	// If it's a fork initialize (make up) previous N BLOCKS
-	
-	if (FORK_HEIGHT >= N+1) {
+	else if (FORK_HEIGHT >= N+1) {
 		TS.resize(N+1);
 		CD.resize(N+1);
 		// Note that TS[N] is not stored. CD must be 1 block ahead because
@@ -606,95 +1456,197 @@ if ( DA == "DIGISHIELD_" ) { N=N+6; } // For simulated MTP = 11 delay.
 		TS.push_back(TS[0]+T); 
 		CD.push_back(CD[0]+BASELINE_D);
 	}
-	else if (FORK_HEIGHT > 1 ) {
-		cout << "This is not the reason the program crashed, but you can't fork if genesis was < N+1 BLOCKS in the past." << endl; 
+	bool warm = snapshot && snapshot->matches(c, N);
+	bool fill_snapshot = snapshot && !warm;
+	if (DA == "RT_CST_RST_" && rt.blocks()) { rt = RT_CST_RST_tracker(T); } // a run() after the 1st
+	rt_TS.clear(); rt_D.clear();
+	if (warm) {
+		TS = snapshot->TS; CD = snapshot->CD;
+		if (o1) { 
+			// A snapshot's window has 2 blocks if an o1 run made it, but any size works.
+			st.D = CD.back() - CD[CD.size()-2]; st.timestamp = TS.back(); st.prev_timestamp = TS.front() - T;
+			for (u k = 0; k+1 < TS.size(); k++) { 
+				st.prev_timestamp = o1 == O1_ETH ? ETH_safe_timestamp(st.prev_timestamp, TS[k]) : TS[k]; 
+			}
+		}
+		next_D = snapshot->next_D; attack_on = snapshot->attack_on;
+		for (u k = 0; k < snapshot->STs.size(); k++) { STs[snapshot->start - snapshot->STs.size() + k] = snapshot->STs[k]; }
+		rt_TS = snapshot->rt_TS; rt_D = snapshot->rt_D;
+		// The 1st block's ST doesn't matter, only the targets after it are summed.
+		for (u k = 0; k < rt_TS.size(); k++) { 
+			rt.add_block(rt_TS[k], RT_CST_RST_ct(rt_D[k], k ? rt_TS[k]-rt_TS[k-1] : T, T)); 
+		}
+	}
+	else if (DA == "RT_CST_RST_") { 
+		for (u k=0; k < TS.size(); k++) { 
+			rt.add_block(TS[k], RT_CST_RST_ct(BASELINE_D, k ? TS[k]-TS[k-1] : T, T)); 
+			if (fill_snapshot) { rt_TS.push_back(TS[k]); rt_D.push_back(BASELINE_D); }
+		}
 	}
 // *****  Run simulation  ********
-previous_ST = T; // initialize in case we are using CN delay.
+PHASE(PH_SETUP);
+clock_t start_clock = clock();
+previous_ST = warm ? snapshot->previous_ST : T; // initialize in case we are using CN delay.
 HR = baseline_HR;
 u height = 0; 
 
-float mN = static_cast<float>(N);
-float mT = static_cast<float>(T);
-
-float avgST(0), avgHR(0), avgD(0), avgDtsa(0);
-
-for (i=0; i <= BLOCKS-1; i++) {
+double avgST(0), avgHR(0), avgD(0), avgDtsa(0); // float sums lose precision over a million blocks
+
+// Batch means for stopping early.
+const precision_target* stop = c.stop;
+u blocks = std::min(c.blocks, u(NEG_LOG_RAND.size())), batch_blocks = 0;
+double b_ST = 0, b_a_reward = 0, b_a_time = 0, b_d_reward = 0, b_d_time = 0, b_delays = 0, ST_hw = 0, st_hw = 0, dl_hw = 0;
+batch_ST.clear(); batch_stolen.clear(); batch_delays.clear();
+
+first = warm ? snapshot->start : 0;
+u from = first;
+// Go on from a checkpoint, or start writing them.
+std::thread writer;
+bool writer_ok = true;
+u logged = 0, next_checkpoint = 0;
+if (checkpoint) {
+	sim_checkpoint& ck = *checkpoint;
+	string state, key;
+	u start = 0;
+	if (ck.resume && read_checkpoint_state(ck.path, state)) {
+		bin_reader in(state);
+		vector<u> ck_rt_TS, ck_rt_D;
+		in.get(key); in.get(start);
+		if (in.ok && key == ck.key && start < blocks) {
+			in.get(first); in.get(next_D); in.get(attack_on); in.get(previous_ST); in.get(TS); in.get(CD); 
+			in.get(st.D); in.get(st.prev_timestamp); in.get(st.timestamp); in.get(ck_rt_TS); in.get(ck_rt_D);
+			in.get(avgST); in.get(avgHR); in.get(avgD); in.get(avgDtsa); in.get(batch_blocks); in.get(b_ST); 
+			in.get(b_a_reward); in.get(b_a_time); in.get(b_d_reward); in.get(b_d_time); in.get(b_delays); 
+			in.get(ST_hw); in.get(st_hw); in.get(dl_hw); in.get(batch_ST); in.get(batch_stolen); in.get(batch_delays);
+			if (!in.ok || !read_checkpoint_blocks(ck.path, start, STs.data(), Ds.data(), HRs.data(), Dtsa.data())) {
+				cout << "Can't resume from " << ck.path << ", starting over." << endl;
+				ck.resume = false;
+				return run(snapshot, checkpoint);
+			}
+			if (DA == "RT_CST_RST_") { 
+				rt = RT_CST_RST_tracker(T);
+				for (u k = 0; k < ck_rt_TS.size(); k++) { 
+					rt.add_block(ck_rt_TS[k], RT_CST_RST_ct(ck_rt_D[k], k ? ck_rt_TS[k]-ck_rt_TS[k-1] : T, T)); 
+				}
+			}
+			fill_snapshot = false;
+			from = logged = ck.resumed_at = start;
+		}
+	}
+	if (!ck.resumed_at) { remove(ck.path.c_str()); ofstream(ck.path + ".blocks", ios::trunc); }
+	next_checkpoint = std::max(SNAPSHOT_RT_BLOCKS, from) / ck.every * ck.every + ck.every;
+}
+auto save_checkpoint = [&](u next) {
+	auto start_wait = chrono::steady_clock::now();
+	if (writer.joinable()) { writer.join(); }
+	if (writer_ok) {
+		bin_writer out;
+		out.put(checkpoint->key); out.put(next); out.put(first); out.put(next_D); out.put(attack_on); 
+		out.put(previous_ST); out.put(TS); out.put(CD); out.put(st.D); out.put(st.prev_timestamp); out.put(st.timestamp);
+		// The tracker's last blocks, back from the newest timestamp.
+		vector<u> ck_rt_TS, ck_rt_D;
+		if (DA == "RT_CST_RST_") {
+			u n = std::min(next, SNAPSHOT_RT_BLOCKS), ts = TS.back();
+			ck_rt_TS.resize(n); ck_rt_D.resize(n);
+			for (u k = 0; k < n; k++) { 
+				ck_rt_TS[n-1-k] = ts; ck_rt_D[n-1-k] = Ds[next-1-k]; ts -= STs[next-1-k]; 
+			}
+		}
+		out.put(ck_rt_TS); out.put(ck_rt_D);
+		out.put(avgST); out.put(avgHR); out.put(avgD); out.put(avgDtsa); out.put(batch_blocks); out.put(b_ST); 
+		out.put(b_a_reward); out.put(b_a_time); out.put(b_d_reward); out.put(b_d_time); out.put(b_delays); 
+		out.put(ST_hw); out.put(st_hw); out.put(dl_hw); out.put(batch_ST); out.put(batch_stolen); out.put(batch_delays);
+		PHASE_BYTES(PH_CHECKPOINT, 8 + out.s.size() + (next - logged)*CHECKPOINT_BLOCK_BYTES);
+		writer = std::thread([this, checkpoint, &writer_ok](string state, u from, u to) {
+			auto start_write = chrono::steady_clock::now();
+			writer_ok = write_checkpoint(checkpoint->path, state, STs.data(), Ds.data(), HRs.data(), Dtsa.data(), from, to);
+			checkpoint->write_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start_write).count();
+			if (writer_ok) { checkpoint->written++; }
+		}, std::move(out.s), logged, next);
+		logged = next;
+	}
+	else { cout << "Can't write checkpoint " << checkpoint->path << ", going on without them." << endl; }
+	checkpoint->wait_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start_wait).count();
+	return writer_ok;
+};
+telemetry_worker* progress = TELEMETRY_WORKER;
+for (i = from; i <= blocks-1; i++) {
+	PHASE_SAMPLE(i);
 	// attack_size = 100 means there's no hash attack, but just constant HR.
-	if (next_D > (attack_stop*BASELINE_D)/100 ) {  attack_on = 0;  HR = baseline_HR;	  }
-	else if (next_D < (attack_start*BASELINE_D)/100 ) { attack_on = 1; HR = (baseline_HR*attack_size)/100; }
+	if (next_D > (c.attack_stop*BASELINE_D)/100 ) {  attack_on = 0; }
+	else if (next_D < (c.attack_start*BASELINE_D)/100 ) { attack_on = 1; }
+	HR = std::max(u(1), u(double(c.profile ? c.profile->at(o1 ? st.timestamp : TS.back()) : 1)*baseline_HR*
+		(attack_on ? c.attack_size : 100)/100));
+	PHASE(PH_BOOKKEEPING);
 
 	if (DA == "ASERT_RTT_") {	
-		if ( i == 0 ) {	//  prevents assert error since this is different from other DAs.
-			CD.push_back(CD.back()+BASELINE_D); 
-			Ds.push_back(BASELINE_D);
-			HRs.push_back(baseline_HR);
-		}
+		//  prevents assert error since this is different from other DAs.
+		if ( i == 0 ) {	CD.push_back(CD.back()+BASELINE_D); }
 		// My old method that Mark Lundeberg showed me was wrong
 		// current_ST = static_cast<u>(0.5+mT*mN/2*(pow(1+NEG_LOG_RAND[i]*4*pow(2.7182,1/mN)*static_cast<float>((CD.back()-CD[CD.size()-2])*DX/HR)/mT/mN,0.5) - 1));
-		// Now implementing t=T*N*ln(1-e^(1/N)*D/(HR*T*N)*ln(x))
-		current_ST = static_cast<u>(0.5+mT*mN*log(1+pow(2.7182,1/mN)*NEG_LOG_RAND[i]
-		*static_cast<float>((CD.back()-CD[CD.size()-2])*DX/HR)/mT/mN));
+		// ASERT_ with M = R where the template's timestamp is the newest one. See rtt_shape_for().
+		current_ST = static_cast<u>(0.5+sampler.solvetime(CD.back()-CD[CD.size()-2], c.dx, HR, NEG_LOG_RAND[i]));
 		simulated_ST = current_ST;
-		cout << NEG_LOG_RAND[i] << " xxx " << current_ST << endl;
+		PHASE(PH_SOLVETIME);
 		TS.push_back(TS.back() + current_ST); 
 		if (TS.size() > N+1 ) { TS.erase(TS.begin()); }
+		PHASE(PH_WINDOW);
 	}
   // if (HR == 0) { HR=1; cout << "HR was zero, so it was changed to 1 to prevent 1/0." << endl; }
   // Run DA
   
 	height = FORK_HEIGHT+i;
 
-		if (DA == "LWMA1_" ) {	next_D = LWMA1_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "LWMA4_" ) {	next_D = LWMA4_(TS,CD,T,N,height,FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "WHR_" ) {	next_D = WHR_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "KGW_" || DA == "Boris_" ) {	next_D = Boris_(TS,CD,T,N,height,FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "DIGISHIELD_" ) { next_D = DIGISHIELD_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }  
-		if (DA == "DIGISHIELD_improved_" ) { next_D = DIGISHIELD_improved_(TS,CD,T,N,height,FORK_HEIGHT, difficulty_guess);  } 
-		if (DA == "SMA_" ) {	next_D = SMA_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "SMS_" ) {	next_D = SMS_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "EMA_" ) {	next_D = EMA_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "EMA3_" ) {	next_D = EMA3_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }  
-		if (DA == "ETH_" ) {	next_D = ETH_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
-		if (DA == "LWMA_ASERT_" ) {	next_D = LWMA_ASERT_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess, R);  }
-		if (DA == "ASERT_" || DA == "ASERT_RTT_" ) {	next_D = ASERT_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess, R);  } 
-		if (DA == "ASERT_SMA_" ) {	next_D = ASERT_SMA_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess, R);  }
-		if (DA == "DGW_" ) {	next_D = DGW_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);  }
+		if (o1) { 
+			next_D = height >= FORK_HEIGHT && height <= FORK_HEIGHT + N+1 ? c.difficulty_guess : st.next_D(o1, T, N, R); 
+		}
+		else if (DA != "TSA_" && DA != "RT_CST_RST_") { 
+			next_D = run_DA(DA,TS,CD,T,N, height, FORK_HEIGHT, c.difficulty_guess, R, c.start_timestamp, BASELINE_D); 
+		}
 		//  **** Begin TSA section  ****
-		if (DA == "ASERT_RTT_") {  }
 		if (DA == "TSA_" ) { 
 				// TSA is set up for use with LWMA1 only.  
-				// It can't simulate ST with CN_delay because it depends on a per-block ST & D connection.
-				USE_CN_DELAY = 0;
 				// CONSTANT_HR=1; //  This was for a different type of miner "attack" used in simulated_ST().
-				next_D = EMA_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess);
-			float mR = R;
-			float mT = T;
-			simulated_ST = static_cast<u>(0.5+mT*mR*log(1+pow(2.7183,1/mR)*NEG_LOG_RAND[i]*
-							static_cast<float>(next_D*DX/mT/mR/HR)));
+				next_D = EMA_(TS,CD,T,N, height, FORK_HEIGHT, c.difficulty_guess);
+			simulated_ST = static_cast<u>(0.5+sampler.solvetime(next_D, c.dx, HR, NEG_LOG_RAND[i]));
 				current_ST = simulated_ST; 
 				 u template_timestamp = current_ST + TS.back();
-			TSA_D =  TSA_(TS,CD,T,N, height, FORK_HEIGHT, difficulty_guess, template_timestamp, R);  
+			TSA_D =  TSA_(TS,CD,T,N, height, FORK_HEIGHT, c.difficulty_guess, template_timestamp, R);  
 		 } 
 		// <-- false indention
 		//  **** End TSA section  ****
+		if (DA == "RT_CST_RST_" ) { 
+			next_D = DIGISHIELD_improved_(TS,CD,T,N,height,FORK_HEIGHT, c.difficulty_guess);
+			simulated_ST = RT_CST_RST_solvetime(rt, next_D, NEG_LOG_RAND[i], HR, T, c.dx);
+			next_D = RT_CST_RST_D(rt, next_D, TS.back() + simulated_ST);
+		}
+		PHASE(PH_DA);
 
 		// CD gets 1 block ahead of TS
-		CD.push_back(CD.back() + next_D);
-		if (CD.size() > N+1 ) { CD.erase(CD.begin()); }
+		if (!o1) { 
+			CD.push_back(CD.back() + next_D);
+			if (CD.size() > N+1 ) { CD.erase(CD.begin()); }
+		}
+		PHASE(PH_WINDOW);
 
 		// Simulate solvetime for this next_D
  
-		if (DA != "TSA_" && DA != "ASERT_RTT_" )  { 
-			simulated_ST = static_cast<u>(NEG_LOG_RAND[i]*(CD.back()-CD[CD.size()-2])*DX/HR);
+		if (DA != "TSA_" && DA != "ASERT_RTT_" && DA != "RT_CST_RST_" )  { 
+			simulated_ST = simulate_ST(o1 ? next_D : CD.back()-CD[CD.size()-2], c.dx, HR, NEG_LOG_RAND[i]);
 		}
-		if (USE_CN_DELAY) {  current_ST = previous_ST; previous_ST = simulated_ST; }
+		if (cn_delay) {  current_ST = previous_ST; previous_ST = simulated_ST; }
 		else { current_ST = simulated_ST; }  // TSA always
+		PHASE(PH_SOLVETIME);
 		// TS catches up with CD
-		if (DA != "ASERT_RTT_" ) {	TS.push_back(TS.back() + current_ST); 
+		if (o1) { st.add_block(o1, next_D, st.timestamp + current_ST); }
+		else if (DA != "ASERT_RTT_" ) {	TS.push_back(TS.back() + current_ST); 
 			if (TS.size() > N+1 ) { TS.erase(TS.begin()); }
 		}
-		// Ds[i]  = CD.back() - CD[CD.size()-2];
+		PHASE(PH_WINDOW);
+		if (DA == "RT_CST_RST_" ) { 
+			rt.add_block(TS.back(), RT_CST_RST_ct(next_D, current_ST, T)); 
+			if (fill_snapshot && i <= 2*N) { rt_TS.push_back(TS.back()); rt_D.push_back(next_D); }
+		}
 		Ds[i] = next_D; 
 		if (DA == "TSA_" ) { Dtsa[i] = TSA_D; } // Dtsa[i] = CD.back() - CD[CD.size()-2];
 
@@ -706,93 +1658,2047 @@ for (i=0; i <= BLOCKS-1; i++) {
 			avgHR += HR;
 			avgDtsa += Dtsa[i];
 		}
-		
-		if (PRINT_BLOCKS_TO_COMMAND_LINE) {  cout << i << "\t" << STs[i] << "\t" << Ds[i] << endl;	}
+		if (fill_snapshot && i == 2*N) {
+			sim_snapshot& s = *snapshot;
+			s.DA = DA; s.T = T; s.N = N; s.M = R; s.baseline_D = BASELINE_D; s.dx = c.dx; s.fork_height = FORK_HEIGHT; 
+			s.start_timestamp = c.start_timestamp; s.start_cd = c.start_cd; s.cn_delay = c.cn_delay;
+			s.start = i+1; s.next_D = next_D; s.attack_on = attack_on; s.previous_ST = previous_ST;
+			if (o1) { s.TS = {st.prev_timestamp, st.timestamp}; s.CD = {c.start_cd, c.start_cd + st.D}; }
+			else { s.TS = TS; s.CD = CD; }
+			s.STs.assign(STs.begin() + (i+1 - std::min(i+1, u(11))), STs.begin() + i+1);
+			u n = std::min(u(rt_TS.size()), SNAPSHOT_RT_BLOCKS);
+			s.rt_TS.assign(rt_TS.end()-n, rt_TS.end()); s.rt_D.assign(rt_D.end()-n, rt_D.end());
+		}
 		// if (Ds[i] < 100 ) { cout << " D went < 100 at iteration " << i << " " << Ds[i] << endl; }
+		if (stop && i > 2*N) {
+			// Same metrics as below, without the rounding.
+			double nST_i = double(current_ST)/T, reward = nST_i/(DA == "TSA_" ? Dtsa[i] : Ds[i]);
+			b_ST += current_ST; b_d_time += nST_i; b_d_reward += reward;
+			if (HR > baseline_HR*1.001) { b_a_time += nST_i; b_a_reward += reward; }
+			if (nST_i > 4) { b_delays += nST_i - 4; }
+			if (i >= 2*N+11) { 
+				double sum11 = 0;
+				for (u j = i-10; j <= i; j++) { sum11 += STs[j]; }
+				if (sum11/11/T > 1.9) { b_delays += double(STs[i-5])/T - 1; }
+			}
+			if (++batch_blocks == stop->batch) {
+				batch_ST.push_back(b_ST/batch_blocks);
+				if (b_a_time > 0) { batch_stolen.push_back(100*((b_a_reward/b_a_time)/(b_d_reward/b_d_time) - 1)); }
+				batch_delays.push_back(100*b_delays/batch_blocks);
+				batch_blocks = 0; b_ST = b_a_reward = b_a_time = b_d_reward = b_d_time = b_delays = 0;
+				if (stop->met(batch_ST, batch_stolen, batch_delays, ST_hw, st_hw, dl_hw)) { blocks = i+1; break; }
+			}
+		}
+		PHASE(PH_BOOKKEEPING);
+		if ((i & (PROGRESS_EVERY-1)) == 0 && progress) { progress->current.store(i, memory_order_relaxed); }
+		if (i+1 == next_checkpoint) { 
+			PHASE_ALL();
+			next_checkpoint = i+1 < blocks && !save_checkpoint(i+1) ? 0 : next_checkpoint + checkpoint->every; 
+			PHASE(PH_CHECKPOINT);
+		}
+	}
+	PHASE_ALL();
+	if (writer.joinable()) {
+		auto start_wait = chrono::steady_clock::now();
+		writer.join();
+		checkpoint->wait_ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start_wait).count();
+		PHASE(PH_CHECKPOINT);
 	}
-	avgST /= (BLOCKS-2*N); avgHR /= (BLOCKS-2*N); avgD /= (BLOCKS-2*N); avgDtsa /= (BLOCKS-2*N);
-	cout << DA << " " << N << " avg ST: " << avgST << " avg Diff: " << avgD << " ";
-	string temp = "blocks_" + DA + ".txt";	ofstream blocks_file(temp);
+	ms = 1000.0*(clock() - start_clock)/CLOCKS_PER_SEC;
+	avgST /= (blocks-2*N); avgHR /= (blocks-2*N); avgD /= (blocks-2*N); avgDtsa /= (blocks-2*N);
 
-	int64_t j=0;
-	vector<int64_t>histotimes(6*T);
-	vector<float>nD(BLOCKS), nDtsa(BLOCKS), nST(BLOCKS), nHR(BLOCKS), nST11(BLOCKS), nAttack(BLOCKS);
-	float SD(0),SD_ST(0);
-	float delays=0, stolen=0, dedicated_reward=0, attackers_reward=0, dedicated_time=0, attackers_time=0;
+	double SD(0),SD_ST(0);
+	float delays=0, dedicated_reward=0, attackers_reward=0, dedicated_time=0, attackers_time=0;
 	int64_t attack_blocks=0; 
 
-	for (i=2*N+1;i<BLOCKS;i++) {	
-		nD[i] = round(Ds[i]*100/avgD)/100;
-		nDtsa[i] = round(Dtsa[i]*100/avgDtsa)/100;
-		nHR[i] = round(HRs[i]*100/baseline_HR)/100;
-		nST[i] = round(STs[i]*100/T)/100; 
+	for (i=2*N+1;i<blocks;i++) {	
+		float nD = round(Ds[i]*100/avgD)/100;
+		float nDtsa = round(Dtsa[i]*100/avgDtsa)/100;
+		// Below 0.5% of the average they round to 0 and the rewards below would be inf.
+		if (nD == 0) { nD = float(Ds[i])/avgD; }
+		if (nDtsa == 0) { nDtsa = float(Dtsa[i])/avgDtsa; }
+		float nHR = round(HRs[i]*100/baseline_HR)/100;
+		float nST = round(STs[i]*100/T)/100; 
 		// if (nHR[i] == 1) { 	// I decided this is not correct
-		dedicated_time += nST[i];
-		DA == "TSA_" ? dedicated_reward += nST[i]/nDtsa[i] : dedicated_reward += nST[i]/nD[i];
+		dedicated_time += nST;
+		DA == "TSA_" ? dedicated_reward += nST/nDtsa : dedicated_reward += nST/nD;
 		// }
-		// cout << "==== " << attackers_reward << endl;
-		// total_time += nST[i];
-		if (nHR[i] > 1.001) { 	attackers_time += nST[i]; attack_blocks++;
-			DA == "TSA_" ? attackers_reward += nST[i]/nDtsa[i] : attackers_reward += nST[i]/nD[i]; 
-		}
-		if ( nST[i] > 4	) { delays += nST[i] - 4; } // This is the delay metric. 
-		if ( STs[i] < 6*T ) { histotimes[STs[i]]++;} //	histogram
-		if (DA == "TSA_" ) { Dtsa[i] =round(Dtsa[i]*100/avgD)/100; }
-		// if (nST[i] > 8 ) { cout << " ST > 8xT " << nST[i] << endl; }
- 
-		if (i >= 5 && i < BLOCKS-5) { 
-			for (int j = i-5; j <= i+5; j++) { nST11[i] += STs[j]; };
-			nAttack[i] = (11*T)/(nST11[i]+1);
-			nAttack[i] = round(nAttack[i]*100)/100;
-			nST11[i]	= round((nST11[i]*100)/(T*11))/100; 
-			if ( nST11[i] > 1.9	) { delays += (nST[i] - 1); }
+		if (nHR > 1.001) { 	attackers_time += nST; attack_blocks++;
+			DA == "TSA_" ? attackers_reward += nST/nDtsa : attackers_reward += nST/nD; 
+		}
+		if ( nST > 4	) { delays += nST - 4; } // This is the delay metric. 
+		if (i >= 5 && i < blocks-5) { 
+			float nST11 = 0;
+			for (int j = i-5; j <= i+5; j++) { nST11 += STs[j]; };
+			nST11	= round((nST11*100)/(T*11))/100; 
+			if ( nST11 > 1.9	) { delays += (nST - 1); }
 			//	if ( nST11[i] < 0.43 && nD[i] < 1) { stolen += 1 - nD[i]; }
 			// if ( nST11[i] < 0.43) { stolen += 1 - nST11[i]; }
 			//	if ( i > 5+4 && nST11[i] < 0.43 && nST11[i-1] < 0.43 && nST11[i-2] < 0.43 && nST11[i-3] >= 0.43 ) { stolen += (1 - nD[i])*5; } // accounts for underestimate in method
-			//	nST11[i] = accumulate(nST[i-5],nST[+5])/11; nAttack[i]=1/nST11[i]; 
 		}  
-		if (ENABLE_FILE_WRITES) { blocks_file << i+FORK_HEIGHT << "\t" << STs[i] << "\t" << Ds[i] << endl;} 
-		SD += (Ds[i]-avgD)*(Ds[i]-avgD)/BLOCKS/avgD/avgD;
-		SD_ST += (STs[i]-avgST)*(STs[i]-avgST)/BLOCKS/avgST/avgST;
+		SD += (Ds[i]-avgD)*(Ds[i]-avgD)/blocks/avgD/avgD;
+		SD_ST += (STs[i]-avgST)*(STs[i]-avgST)/blocks/avgST/avgST;
 	}
+	r.avgST = avgST; r.avgD = avgD; r.SD_D = sqrt(SD); r.SD_ST = sqrt(SD_ST);
+	r.delays = 100.0*delays/(blocks-2*N);
+	r.stolen = 100.0*((attackers_reward/attackers_time)/(dedicated_reward/dedicated_time)-1);
+	r.avgST_hw = ST_hw; r.stolen_hw = st_hw; r.delays_hw = dl_hw; r.blocks = blocks;
+	r.avgHR = avgHR; r.avgDtsa = avgDtsa; r.TWA_D = dedicated_time/dedicated_reward*avgD; r.attack_blocks = attack_blocks;
+	PHASE(PH_METRICS);
+	return r;
+}
 
-	stolen =round(10000*((attackers_reward/attackers_time)/(dedicated_reward/dedicated_time)-1))/100;
-	delays = round(10000*delays/(BLOCKS-2*N))/100;
-	float stolen_blocks = stolen*attack_blocks/100;
+int run_simulation(string DA, u T, u N,u difficulty_guess,u baseline_HR,u attack_start,u attack_stop,u attack_size, u R,
+					sim_metrics* metrics = 0, const precision_target* stop = 0, sim_snapshot* snapshot = 0) {
 
-	cout << delays << "% delays. " << attack_blocks << 
-	" attack_blocks. " << stolen << "% cheaper (" << stolen_blocks << " 'free' blocks) for on-off mining. " << endl;
+if (!QUIET) cout << DA << " blocks to simulate: " << BLOCKS << ". Baseline Diff: " << BASELINE_D << ". Target timespan: " << T << 
+". Start/stop (attacks size) as multiples of baseline difficulty (hashrate): " << float(attack_start)/100 << " / " << 
+float(attack_stop)/100 << " (" << float(attack_size)/100 << ")" << endl;
 
-	if (ENABLE_FILE_WRITES) { blocks_file.close(); }
+	// R is used for EMA and TSA
+	sim_config c;
+	c.DA = DA; c.T = T; c.N = N; c.M = R; c.blocks = BLOCKS;
+	c.baseline_D = BASELINE_D; c.difficulty_guess = difficulty_guess; c.baseline_HR = baseline_HR; 
+	c.fork_height = FORK_HEIGHT; c.start_timestamp = START_TIMESTAMP; c.start_cd = START_CD; c.dx = DX; 
+	c.cn_delay = USE_CN_DELAY; c.attack_start = attack_start; c.attack_stop = attack_stop; c.attack_size = attack_size;
+	c.draws = &NEG_LOG_RAND; c.profile = &HR_PROFILE; c.stop = stop;
+	PHASE_RESET();
+	simulation sim(c);
+	N = sim.window();
+	if (FORK_HEIGHT > 1 && FORK_HEIGHT < N+1) {
+		cout << "This is not the reason the program crashed, but you can't fork if genesis was < N+1 BLOCKS in the past." << endl; 
+	}
+	if (snapshot && snapshot->start && !snapshot->matches(c, N) && !QUIET) { 
+		cout << "Snapshot is for other settings, starting cold." << endl; 
+	}
+	const sim_metrics& r = sim.run(snapshot);
+	if (metrics) { *metrics = r; }
+	if (QUIET) { return 0; }
+
+	u blocks = r.blocks, i;
+	const vector<u>& STs = sim.solvetimes();
+	const vector<u>& Ds = sim.difficulties();
+	const vector<u>& HRs = sim.hashrates();
+	if (PRINT_BLOCKS_TO_COMMAND_LINE) {  
+		for (i = sim.first_block(); i < blocks; i++) { cout << i << "\t" << STs[i] << "\t" << Ds[i] << endl; }
+	}
+	cout << DA << " " << N << " avg ST: " << r.avgST << " avg Diff: " << r.avgD << " " << sim.run_ms() << " ms. ";
+	float delays = round(100*r.delays)/100, stolen = round(100*r.stolen)/100;
+	float stolen_blocks = stolen*r.attack_blocks/100;
+	cout << delays << "% delays. " << r.attack_blocks << 
+	" attack_blocks. " << stolen << "% cheaper (" << stolen_blocks << " 'free' blocks) for on-off mining. " << endl;
+	log_histogram ST_hist(1), D_hist(1000);
+	for (i=2*N+1;i<blocks;i++) { ST_hist.record_scaled(STs[i]); D_hist.record(Ds[i]/r.avgD); }
+	cout << "Solvetime p50/p99/p99.99: " << ST_hist.percentiles() << " s. Normalized D p50/p99/p99.99: " << 
+		D_hist.percentiles() << endl;
+	PHASE(PH_METRICS);
 
+	vector<int64_t>histotimes(6*T);
+	for (i=2*N+1;i<blocks;i++) { if ( STs[i] < 6*T ) { histotimes[STs[i]]++;} }
 	ofstream histo_file("histogram" + DA + to_string(IDENTIFIER) + ".txt");
 	for (int i=0;i<6*T;i++) { histo_file << i << "\t" << histotimes[i] << endl; }
+	PHASE_BYTES(PH_FILES, u(histo_file.tellp()));
 	histo_file.close();
+	ofstream log_histo_file("loghistogram" + DA + to_string(IDENTIFIER) + ".txt");
+	log_histo_file << ST_hist.compact() << endl << D_hist.compact() << endl;
+	PHASE_BYTES(PH_FILES, u(log_histo_file.tellp()));
+	PHASE(PH_FILES);
 
 	if (ENABLE_FILE_WRITES) {
-		temp = "plot_" + DA + to_string(IDENTIFIER) + ".txt";	ofstream plot_file(temp);
-		for (i=2*N+1;i<BLOCKS;i++) {	
-			plot_file << i+FORK_HEIGHT << "\t" << nD[i] << "\t" << nST[i] << "\t" << nHR[i] << "\t" << nST11[i] << "\t" << nAttack[i] << "\t" << Dtsa[i] << endl;
+		ofstream blocks_file("blocks_" + DA + ".txt");
+		for (i=2*N+1;i<blocks;i++) { blocks_file << i+FORK_HEIGHT << "\t" << STs[i] << "\t" << Ds[i] << endl; } 
+		PHASE_BYTES(PH_FILES, u(blocks_file.tellp()));
+		blocks_file.close();
+		string temp = "plot_" + DA + to_string(IDENTIFIER) + ".txt";	ofstream plot_file(temp);
+		for (i=2*N+1;i<blocks;i++) {	
+			float nD = round(Ds[i]*100/r.avgD)/100, nST = round(STs[i]*100/T)/100, nHR = round(HRs[i]*100/baseline_HR)/100;
+			float nST11 = 0, nAttack = 0, Dtsa = DA == "TSA_" ? round(sim.TSA_difficulties()[i]*100/r.avgD)/100 : 0;
+			if (i >= 5 && i < blocks-5) { 
+				for (u j = i-5; j <= i+5; j++) { nST11 += STs[j]; };
+				nAttack = (11*T)/(nST11+1);
+				nAttack = round(nAttack*100)/100;
+				nST11	= round((nST11*100)/(T*11))/100; 
+			}
+			plot_file << i+FORK_HEIGHT << "\t" << nD << "\t" << nST << "\t" << nHR << "\t" << nST11 << "\t" << nAttack << "\t" << Dtsa << endl;
 		}
+		PHASE_BYTES(PH_FILES, u(plot_file.tellp()));
 		plot_file.close();
-		int spacing = BLOCKS/60;
-		int end = FORK_HEIGHT+BLOCKS;
+		PHASE(PH_FILES);
+		int spacing = blocks/60;
+		int end = FORK_HEIGHT+blocks;
 		temp = "gnuplot -c test_DAs_gnuplot.txt " + to_string(FORK_HEIGHT) + " " + to_string(end) + " " + 
 			to_string(spacing) + " " + DA + to_string(IDENTIFIER) + " " + to_string(11) ;
 		system((temp).c_str() );
+		PHASE(PH_GNUPLOT);
 		// if ( DA == "DIGISHIELD_" ) { N=N-6; }
-		html_file << "<B>" << DA << "</B> Target ST/avgST= " << T << "/" << avgST << " N= " << N;  
+		html_file << "<B>" << DA << "</B> Target ST/avgST= " << T << "/" << r.avgST << " N= " << N;  
 		if (attack_size != 100) { html_file << " attack_size: " << attack_size << " start/start: " 
 		 << attack_start << "/" << attack_stop;}
-		html_file << " StdDev Diffs: " << round(1000*sqrt(SD))/1000 << " StdDev STs: " << 
-		round(100*sqrt(SD_ST))/100 << " delays: " << delays << "% stolen: " << stolen << 
-		"%  TWAavgD: " << round(1000*dedicated_time/dedicated_reward*avgD)/1000 << "  M=" << R << "\n<br><img src=gif_" << 
+		html_file << " StdDev Diffs: " << round(1000*r.SD_D)/1000 << " StdDev STs: " << 
+		round(100*r.SD_ST)/100 << " delays: " << delays << "% stolen: " << stolen << 
+		"%  TWAavgD: " << round(1000*r.TWA_D)/1000 << "  M=" << R << " ST p50/p99/p99.99: " << ST_hist.percentiles() << 
+		" D p50/p99/p99.99: " << D_hist.percentiles() << "\n<br><img src=gif_" << 
 		DA << to_string(IDENTIFIER) << ".gif><br>" << endl;
+		PHASE(PH_FILES);
 	}
+	PHASE_REPORT(cout, PHASE_NAMES, PHASES, false);
+	if (ENABLE_FILE_WRITES) { PHASE_REPORT(html_file, PHASE_NAMES, PHASES, true); }
+	return 0;
 } 
 
-int main() 
+// ==============================================
+//  =========	REPLAY RECORDED HEADERS  ========
+// ==============================================
+/* This runs the DAs on a real chain instead of a simulated one. A header file is a 16-byte file header 
+("DAHDRS1" then a 4-byte 1 if the 3rd field is nBits instead of difficulty, then 4 bytes of 0) followed by 
+24-byte records of height, timestamp, and difficulty (or nBits). make_header_file() converts a text file with 
+"height timestamp difficulty" (or nBits in hex) on each line. The file is memory-mapped so millions of headers 
+don't need to be read in, and each DA streams through it with a fixed N+1 window, so nothing is allocated per block.
+
+At each block the DA's next_D is compared to the recorded D. The recorded D and solvetime give the hashrate, 
+so the solvetime the DA would have had is estimated as recorded ST * next_D / recorded D.  Avg ST, StdDev, and 
+delays are the same metrics run_simulation() prints, done on those estimated solvetimes. 
+Difficulty needs to be in the 1E4 to 1E13 range for the harmonic mean DAs, so choose DX with that in mind.  */
+
+struct header_record { u height, timestamp, difficulty; };
+struct header_file { 
+	const header_record* headers; u count; u uses_nBits; 
+	u dx; // recorded_D()'s DX, 2^32 for nBits files unless the caller changes it
+	void* map; size_t map_size; 
+};
+const char HEADER_MAGIC[8] = "DAHDRS1";
+
+void close_header_file(header_file& hf) { if (hf.map) { munmap(hf.map, hf.map_size); hf.map = 0; } }
+bool open_header_file(const string& path, header_file& hf) {
+	hf.headers = 0; hf.count = 0; hf.map = 0; hf.map_size = 0; hf.dx = 1;
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) { cout << "Can't open " << path << endl; return false; }
+	struct stat st;
+	fstat(fd, &st);
+	if (st.st_size < 16 || (st.st_size-16) % sizeof(header_record) != 0) { 
+		cout << path << " is not a header file." << endl; close(fd); return false; 
+	}
+	hf.map_size = st.st_size;
+	hf.map = mmap(0, hf.map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (hf.map == MAP_FAILED) { cout << "mmap failed for " << path << endl; hf.map = 0; return false; }
+	madvise(hf.map, hf.map_size, MADV_SEQUENTIAL);
+	const char* p = static_cast<const char*>(hf.map);
+	if (memcmp(p, HEADER_MAGIC, 8) != 0) { cout << path << " is not a header file." << endl; close_header_file(hf); return false; }
+	uint32_t flag; memcpy(&flag, p+8, 4);
+	hf.uses_nBits = flag;
+	hf.dx = flag ? 1ULL << 32 : 1;
+	hf.headers = reinterpret_cast<const header_record*>(p+16);
+	hf.count = (hf.map_size-16)/sizeof(header_record);
+	return true;
+}
+
+// Text "height timestamp difficulty" (or nBits in hex) lines to a header file. Returns headers written.
+u make_header_file(const string& in, const string& out, u uses_nBits) {
+	ifstream text(in);
+	ofstream bin(out, ios::binary);
+	uint32_t flag = uses_nBits, zero = 0;
+	bin.write(HEADER_MAGIC, 8); bin.write((char*)&flag, 4); bin.write((char*)&zero, 4);
+	header_record h;
+	string third;
+	u count = 0;
+	while (text >> h.height >> h.timestamp >> third) {
+		h.difficulty = strtoull(third.c_str(), 0, uses_nBits ? 16 : 10);
+		bin.write((char*)&h, sizeof(h));
+		count++;
+	}
+	return count;
+}
+u recorded_D(const header_record& h, u uses_nBits, u dx) {
+	if (!uses_nBits) { return h.difficulty; }
+	uint256 target; target.SetCompact(h.difficulty);
+	if (target == 0) { return 0; }
+	return ((~uint256(0))/target/dx).GetLow64();
+}
+
+// What replay prints for one DA: next_D is what the DA says for a header whose recorded D and solvetime are D and 
+// solvetime. The solvetime it would have had is solvetime*next_D/D.
+struct replay_stats {
+	u blocks = 0;
+	double sum_ratio=0, sum_ratio2=0, sum_abs_err=0, sum_ST=0, sum_ST2=0, sum_D=0, sum_D2=0, delays=0, sum11=0;
+	double nST11[11] = {0};
+	void add(u next_D, u D, int64_t solvetime, u T) {
+		double ratio = double(next_D)/D;
+		double ST = std::max(0.0, double(solvetime))*ratio;
+		double nST = ST/T;
+		sum_ratio += ratio; sum_ratio2 += ratio*ratio; sum_abs_err += fabs(ratio-1);
+		sum_ST += ST; sum_ST2 += ST*ST; sum_D += next_D; sum_D2 += double(next_D)*next_D;
+		if ( nST > 4 ) { delays += nST - 4; }
+		// 11-block centered average of solvetimes
+		sum11 += nST - nST11[blocks % 11];
+		nST11[blocks % 11] = nST;
+		if (blocks >= 10 && sum11/11 > 1.9) { delays += nST11[(blocks-5) % 11] - 1; }
+		blocks++;
+	}
+	void print(const string& DA, u N, u headers_per_sec) const {
+		double avgST = sum_ST/blocks, avgD = sum_D/blocks, avg_ratio = sum_ratio/blocks;
+		cout << DA << " N=" << N << " avg ST: " << avgST << " StdDev Diffs: " << 
+			round(1000*sqrt(std::max(0.0, sum_D2/blocks/avgD/avgD - 1)))/1000 << " StdDev STs: " << 
+			round(100*sqrt(std::max(0.0, sum_ST2/blocks/avgST/avgST - 1)))/100 << " delays: " << 
+			round(10000*delays/blocks)/100 << "% next_D/recorded D: " << avg_ratio << " +/- " << 
+			sqrt(std::max(0.0, sum_ratio2/blocks - avg_ratio*avg_ratio)) << " (avg |error| " << 
+			round(10000*sum_abs_err/blocks)/100 << "%) " << headers_per_sec << " headers/sec" << endl;
+	}
+};
+
+void replay_DA(const string& DA, const header_file& hf, u T, u N, u M) {
+	if (DA == "DIGISHIELD_" ) { N=N+6; } // For simulated MTP = 11 delay, same as run_simulation()
+	if ((DA == "WHR_" || DA == "LWMA_ASERT_") && N%2) { cout << DA << " needs an even N." << endl; return; }
+	if (DA == "KGW_" && N > 1050) { cout << DA << " needs N <= 1050." << endl; return; }
+	if (hf.count < N+3) { cout << "Need more than N+2 headers." << endl; return; }
+	const header_record* h = hf.headers;
+
+	// ASERT_SMA_ and ASERTI3_ are anchored to these.
+	u fork_height = h[0].height, anchor_timestamp = h[0].timestamp, anchor_D = recorded_D(h[0], hf.uses_nBits, hf.dx);
+
+	vector<u> TS, CD;  TS.reserve(N+2); CD.reserve(N+2);
+	u cumulative_D = 0, next_D, D;
+	replay_stats r;
+	auto start = chrono::steady_clock::now();
+	for (u i = 0; i < hf.count; i++) {
+		D = recorded_D(h[i], hf.uses_nBits, hf.dx);
+		if (i >= N+2 && D > 0) { // TS and CD hold headers i-N-1 to i-1.
+			next_D = run_DA(DA, TS, CD, T, N, h[i].height, fork_height, CD.back()-CD[N-1], M, anchor_timestamp, anchor_D);
+			r.add(next_D, D, int64_t(h[i].timestamp - h[i-1].timestamp), T);
+		}
+		cumulative_D += D;
+		TS.push_back(h[i].timestamp); CD.push_back(cumulative_D);
+		if (TS.size() > N+1) { TS.erase(TS.begin()); CD.erase(CD.begin()); }
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	r.print(DA, N, u(hf.count/seconds));
+}
+
+// dx 0 is the file's.
+void replay(const string& path, u T, u N, u M, u dx) {
+	header_file hf;
+	if (!open_header_file(path, hf)) { return; }
+	if (dx) { hf.dx = dx; }
+	cout << "Replaying " << hf.count << " headers from " << path << (hf.uses_nBits ? " (nBits)" : "") << 
+		" T=" << T << " N=" << N << " M=" << M << endl;
+	for (u k = 0; k < WINDOW_DAS.size(); k++) { replay_DA(WINDOW_DAS[k], hf, T, N, M); }
+	close_header_file(hf);
+}
+
+// ==============================================
+//  =========	MULTI-N REPLAY  =================
+// ==============================================
+/* replay for many N (and M) in one pass. SMA_, DIGISHIELD_, DIGISHIELD_improved_ and LWMA1_ are sums over the window,
+so with prefix sums of the headers each is O(1) per header for any N: 
+	Q = sum of 1e13/D, the harmonic means' terms
+	S = sum of s_j, the solvetimes LWMA1_ uses (out-of-sequence timestamps made safe, at most 6*T)
+	W = sum of j*s_j, so LWMA1_'s sum of i*s over a window starting at header a is W[b]-W[a] - a*(S[b]-S[a]) 
+These are kept in rings of the last max N + 8 headers, so memory doesn't grow with the file. The prefix sums wrap
+mod 2^64 but their differences are exact. LWMA1_ makes timestamps safe starting from the window's 1st timestamp, so
+where that one is out of sequence the window's first solvetimes are done the slow way until they agree with S. ASERT_,
+ASERT_SMA_ and ASERTI3_ only need the last 2 headers and are done for each M. All are identical to the window 
+versions in replay, and "check" runs those too and counts the differences. */
+enum { MULTI_SMA, MULTI_DIGISHIELD, MULTI_DIGISHIELD_IMPROVED, MULTI_LWMA1, MULTI_ASERT };
+struct multi_DA { string DA; int kind; u N, M; replay_stats r; };
+
+int replay_multi(const string& path, u T, const vector<u>& Ns, const vector<u>& Ms, const vector<string>& DAs, bool check) {
+	header_file hf;
+	if (!open_header_file(path, hf)) { return 1; }
+	const header_record* h = hf.headers;
+	vector<multi_DA> v;
+	for (const string& DA : DAs) {
+		int kind = DA == "SMA_" ? MULTI_SMA : DA == "DIGISHIELD_" ? MULTI_DIGISHIELD : DA == "DIGISHIELD_improved_" ? 
+			MULTI_DIGISHIELD_IMPROVED : DA == "LWMA1_" ? MULTI_LWMA1 : MULTI_ASERT;
+		if (kind == MULTI_ASERT && DA != "ASERT_" && DA != "ASERT_SMA_" && DA != "ASERTI3_") { 
+			cout << DA << " isn't one of SMA_ LWMA1_ DIGISHIELD_ DIGISHIELD_improved_ ASERT_ ASERT_SMA_ ASERTI3_" << endl;
+			return 1;
+		}
+		// The ASERTs start where replay does with the 1st N.
+		if (kind == MULTI_ASERT) { for (u M : Ms) { v.push_back({DA, kind, Ns[0], M, replay_stats()}); } }
+		else { for (u N : Ns) { v.push_back({DA, kind, kind == MULTI_DIGISHIELD ? N+6 : N, 0, replay_stats()}); } }
+	}
+	u max_N = 0;
+	for (auto& x : v) { max_N = std::max(max_N, x.N); }
+	if (hf.count < max_N+3) { cout << "Need more than N+2 headers." << endl; close_header_file(hf); return 1; }
+	cout << "Replaying " << hf.count << " headers from " << path << (hf.uses_nBits ? " (nBits)" : "") << " T=" << T << 
+		" for " << v.size() << " DAs in 1 pass" << endl;
+	u fork_height = h[0].height, anchor_timestamp = h[0].timestamp, anchor_D = recorded_D(h[0], hf.uses_nBits, hf.dx);
+
+	// A power of 2 so the % R below are masks.
+	u R = 1;
+	while (R < max_N + 8) { R *= 2; }
+	vector<u> TSr(R), SAFE(R), CDr(R), Q(R), S(R), W(R);
+	vector<u> TS, CD, ts2(2), cd2(2);
+	u cumulative_D = 0, mismatches = 0;
+	auto start = chrono::steady_clock::now();
+	for (u i = 0; i < hf.count; i++) {
+		u D = recorded_D(h[i], hf.uses_nBits, hf.dx);
+		if (D > 0 && i >= 2) {
+			u b = i-1; 
+			u ts_b = TSr[b % R], cd_b = CDr[b % R], D_b = cd_b - CDr[(b-1) % R];
+			ts2[0] = TSr[(b-1) % R]; ts2[1] = ts_b; cd2[0] = CDr[(b-1) % R]; cd2[1] = cd_b;
+			for (auto& x : v) {
+				u N = x.N;
+				if (i < N+2) { continue; }
+				u a = i-N-1, next_D;
+				if (h[i].height >= fork_height && h[i].height <= fork_height + N+1) { next_D = D_b; }
+				else if (x.kind == MULTI_SMA || x.kind == MULTI_DIGISHIELD_IMPROVED) {
+					if (x.kind == MULTI_SMA && h[i].height <= N+1) { next_D = D_b; }
+					else {
+						u hm = N*1e13/(Q[b % R] - Q[a % R]);
+						u ST = std::max(N, ts_b - TSr[a % R]);
+						next_D = x.kind == MULTI_SMA ? hm*T*N/ST : ((hm*T*400)/(300*N*T+100*ST))*N;
+					}
+				}
+				else if (x.kind == MULTI_DIGISHIELD) {
+					u hm = (N-6)*1e13/(Q[b % R] - Q[(a+6) % R]);
+					u ST = std::max(N, TSr[(b-6) % R] - TSr[a % R]);
+					next_D = ((hm*T*400)/(300*(N-6)*T+100*ST))*(N-6);
+				}
+				else if (x.kind == MULTI_LWMA1) {
+					u L = 0, j = a, prev = TSr[a % R];
+					// The window's own safe timestamps until they're the same as the prefix sums'.
+					while (j < b && prev != SAFE[j % R]) {
+						j++;
+						u t = TSr[j % R] > prev ? TSr[j % R] : prev+1;
+						L += (j-a)*std::min(6*T, t - prev);
+						prev = t;
+					}
+					L += W[b % R] - W[j % R] - a*(S[b % R] - S[j % R]);
+					if (L < N*N*T/20 ) { L =  N*N*T/20; }
+					u avg_D = (cd_b - CDr[a % R])/N;
+					if (avg_D > 2000000*N*N*T) { next_D = (avg_D/(200*L))*(N*(N+1)*T*99); }	
+					else { next_D = (avg_D*N*(N+1)*T*99)/(200*L); }	
+				}
+				else { next_D = run_DA(x.DA, ts2, cd2, T, 1, h[i].height, fork_height, D_b, x.M, anchor_timestamp, anchor_D); }
+				x.r.add(next_D, D, int64_t(h[i].timestamp - h[i-1].timestamp), T);
+				if (check) {
+					TS.clear(); CD.clear();
+					for (u k = a; k <= b; k++) { TS.push_back(TSr[k % R]); CD.push_back(CDr[k % R]); }
+					if (run_DA(x.DA, TS, CD, T, N, h[i].height, fork_height, D_b, x.M, anchor_timestamp, anchor_D) != next_D) { mismatches++; }
+				}
+			}
+		}
+		cumulative_D += D;
+		u s = 0, safe = h[i].timestamp;
+		if (i > 0) {
+			u prev = SAFE[(i-1) % R];
+			if (safe <= prev) { safe = prev+1; }
+			s = std::min(6*T, safe - prev);
+		}
+		TSr[i % R] = h[i].timestamp; SAFE[i % R] = safe; CDr[i % R] = cumulative_D;
+		Q[i % R] = (i > 0 ? Q[(i-1) % R] : 0) + (D > 0 ? u(1e13/D) : 0);
+		S[i % R] = (i > 0 ? S[(i-1) % R] : 0) + s;
+		W[i % R] = (i > 0 ? W[(i-1) % R] : 0) + i*s;
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	for (auto& x : v) { x.r.print(x.DA + (x.M ? " M=" + to_string(x.M) : ""), x.N, u(hf.count/seconds)); }
+	if (check) { cout << mismatches << " next_D differ from the window versions." << endl; }
+	close_header_file(hf);
+	return mismatches > 0;
+}
+
+// ==============================================
+//  =========	PARALLEL HEADER VERIFICATION  ===
+// ==============================================
+/* A node doing initial header sync has to check every header's difficulty. With an O(N) DA like LWMA1_ that 
+is count*N work. But a DA only looks at the previous N+1 headers, so the range can be cut into segments that 
+are each seeded with the N+1 headers before them and checked on separate threads. O(1) DAs with an anchor 
+like ASERT_SMA_ are the same thing with less to seed. The first N+2 headers are trusted (as in replay).
+Returns the first height whose recorded difficulty isn't what the DA says, or -1 if they are all valid.  */
+
+int64_t verify_segment(const string& DA, const header_record* h, u start, u end, u uses_nBits, u dx, 
+						u T, u N, u M, atomic<int64_t>& first_bad) {
+	// ASERT_SMA_ and ASERTI3_ are anchored to the 1st header.
+	u fork_height = h[0].height, anchor_timestamp = h[0].timestamp, anchor_D = recorded_D(h[0], uses_nBits, dx);
+	vector<u> TS, CD;  TS.reserve(N+2); CD.reserve(N+2);
+	u cumulative_D = 0;
+	for (u i = start-N-1; i < start; i++) {
+		cumulative_D += recorded_D(h[i], uses_nBits, dx);
+		TS.push_back(h[i].timestamp); CD.push_back(cumulative_D);
+	}
+	for (u i = start; i < end; i++) {
+		// Another thread found an earlier bad header, so there's nothing left to find here.
+		if ((i & 1023) == 0 && first_bad.load(memory_order_relaxed) >= 0 && 
+			u(first_bad.load(memory_order_relaxed)) < i) { return -1; }
+		u D = recorded_D(h[i], uses_nBits, dx);
+		if (run_DA(DA, TS, CD, T, N, h[i].height, fork_height, CD.back()-CD[N-1], M, anchor_timestamp, anchor_D) != D) { 
+			return i; 
+		}
+		cumulative_D += D;
+		TS.erase(TS.begin()); CD.erase(CD.begin());
+		TS.push_back(h[i].timestamp); CD.push_back(cumulative_D);
+	}
+	return -1;
+}
+
+int64_t verify_headers(const string& DA, const header_record* h, u count, u uses_nBits, u dx, u T, u N, u M, 
+						u threads = 0, u segment = 0) {
+	if (DA == "DIGISHIELD_" ) { N=N+6; }
+	if (count < N+3) { return -1; }
+	if (threads == 0) { threads = std::max(1U, thread::hardware_concurrency()); }
+	if (segment == 0) { segment = std::max(u(10000), (count-N-2)/(16*threads)+1); }
+	u segments = (count-N-2 + segment-1)/segment;
+	atomic<u> next_segment(0);
+	atomic<int64_t> first_bad(-1); // index into h, not height
+	auto worker = [&]() {
+		u k;
+		while ((k = next_segment++) < segments) {
+			u start = N+2 + k*segment, end = std::min(count, start+segment);
+			int64_t bad = first_bad.load();
+			if (bad >= 0 && u(bad) < start) { continue; }
+			bad = verify_segment(DA, h, start, end, uses_nBits, dx, T, N, M, first_bad);
+			if (bad < 0) { continue; }
+			int64_t old = first_bad.load();
+			while ((old < 0 || bad < old) && !first_bad.compare_exchange_weak(old, bad)) { }
+		}
+	};
+	vector<thread> pool;
+	for (u t = 1; t < threads; t++) { pool.push_back(thread(worker)); }
+	worker();
+	for (u t = 0; t < pool.size(); t++) { pool[t].join(); }
+	return first_bad < 0 ? -1 : int64_t(h[first_bad].height);
+}
+
+// Make a valid chain for DA with on-off mining so there's something to check.
+vector<header_record> make_valid_headers(const string& DA, u count, u T, u N, u M) {
+	if (DA == "DIGISHIELD_" ) { N=N+6; }
+	vector<header_record> h(count);
+	u D0 = 1e6, HR = D0/T, cumulative_D = 0, start_timestamp = 1540000000;
+	vector<u> TS, CD;
+	for (u i = 0; i < count; i++) {
+		u D = i < N+2 ? D0 : run_DA(DA, TS, CD, T, N, i, 0, CD.back()-CD[N-1], M, start_timestamp, D0);
+		u attack = (i/1000) % 3 == 0 ? 3 : 1;
+		h[i].height = i;
+		h[i].timestamp = i == 0 ? start_timestamp : h[i-1].timestamp + u(log(1/fRand(0.000001,0.999999))*D/HR/attack);
+		h[i].difficulty = D;
+		cumulative_D += D;
+		TS.push_back(h[i].timestamp); CD.push_back(cumulative_D);
+		if (TS.size() > N+1) { TS.erase(TS.begin()); CD.erase(CD.begin()); }
+	}
+	return h;
+}
+
+void verify_benchmark(u count, u threads) {
+	if (threads == 0) { threads = std::max(1U, thread::hardware_concurrency()); }
+	u T = 600, Ns[3] = {60, 144, 600};
+	string DAs[2] = {"LWMA1_", "ASERT_SMA_"};
+	cout << "Verifying " << count << " headers. DA, N, sequential sec, " << threads << 
+		" thread sec, speedup, first invalid height (sequential / parallel)" << endl;
+	for (int d = 0; d < 2; d++) { for (int n = 0; n < 3; n++) {
+		u N = Ns[n], M = 32;
+		vector<header_record> h = make_valid_headers(DAs[d], count, T, N, M);
+		auto t0 = chrono::steady_clock::now();
+		int64_t valid1 = verify_headers(DAs[d], h.data(), count, 0, 1, T, N, M, 1, count);
+		auto t1 = chrono::steady_clock::now();
+		int64_t valid2 = verify_headers(DAs[d], h.data(), count, 0, 1, T, N, M, threads);
+		auto t2 = chrono::steady_clock::now();
+		double seq = chrono::duration<double>(t1-t0).count(), par = chrono::duration<double>(t2-t1).count();
+		// Now break 2 headers to see that the earlier one is reported.
+		h[count*3/4].difficulty++; h[count/3].difficulty--;
+		int64_t bad1 = verify_headers(DAs[d], h.data(), count, 0, 1, T, N, M, 1, count);
+		int64_t bad2 = verify_headers(DAs[d], h.data(), count, 0, 1, T, N, M, threads);
+		cout << DAs[d] << "\t" << N << "\t" << seq << "\t" << par << "\t" << seq/par << "\t" << bad1 << " / " << bad2;
+		if (valid1 != -1 || valid2 != -1 || bad1 != int64_t(count/3) || bad2 != bad1) { cout << "  ERROR"; }
+		cout << endl;
+	} }
+}
+
+// ==============================================
+//  =========	NEXT DIFFICULTY SERVICE  ========
+// ==============================================
+/* For pool software that needs the next difficulty as soon as a block arrives. It keeps the DA's N+1 window 
+and the next difficulty up to date as headers are added, so a query is just a lookup. It keeps max_reorg extra 
+headers so a reorg only has to rebuild the window. Commands, one per line, each answered with one line:
+	add height timestamp difficulty    a height at or below the tip is a reorg to that height first
+	reorg height                       drop headers at and above height
+	load headers.bin                   add every header in a header file (a stand-in for the node feed)
+	next                               "height difficulty" for the next block
+	stats                              counts and p50/p99 latency of add and next in microseconds
+	quit
+It reads stdin or listens on a Unix socket. The latency is the time to handle the command, not the I/O.  */
+
+class DA_service {
+public:
+	DA_service(const string& DA_, u T_, u N_, u M_, u max_reorg_ = 100) : DA(DA_), T(T_), N(N_), M(M_), 
+			max_reorg(max_reorg_), next_D(0), headers(0), reorgs(0), add_count(0), next_count(0), fork_height(0), 
+			anchor_timestamp(0), anchor_D(0) {
+		if (DA == "DIGISHIELD_" ) { N=N+6; }
+		TS.reserve(N+2); CD.reserve(N+2);
+		add_ns.assign(LATENCY_SAMPLES, 0); next_ns.assign(LATENCY_SAMPLES, 0);
+	}
+	string handle(const string& line) {
+		auto start = chrono::steady_clock::now();
+		istringstream in(line);
+		string cmd, reply;
+		in >> cmd;
+		if (cmd == "next") {
+			if (history.empty()) { reply = "error no headers"; }
+			else { reply = to_string(history.back().height+1) + " " + to_string(next_D); }
+			next_ns[next_count++ % LATENCY_SAMPLES] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-start).count();
+		}
+		else if (cmd == "add") {
+			header_record h;
+			if (!(in >> h.height >> h.timestamp >> h.difficulty)) { reply = "error usage: add height timestamp difficulty"; }
+			else { reply = add(h); }
+			add_ns[add_count++ % LATENCY_SAMPLES] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-start).count();
+		}
+		else if (cmd == "reorg") {
+			u height;
+			if (!(in >> height)) { reply = "error usage: reorg height"; }
+			else { reply = reorg(height); }
+		}
+		else if (cmd == "load") {
+			string path; in >> path;
+			header_file hf;
+			if (!open_header_file(path, hf)) { reply = "error can't load " + path; }
+			else { 
+				for (u i = 0; i < hf.count && reply.substr(0,5) != "error"; i++) {
+					auto t = chrono::steady_clock::now();
+					header_record h = hf.headers[i];
+					h.difficulty = recorded_D(h, hf.uses_nBits, hf.dx);
+					reply = add(h); 
+					add_ns[add_count++ % LATENCY_SAMPLES] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now()-t).count();
+				}
+				close_header_file(hf);
+			}
+		}
+		else if (cmd == "stats") { reply = stats(); }
+		else if (cmd == "quit") { reply = "bye"; }
+		else { reply = "error unknown command " + cmd; }
+		return reply;
+	}
+	string stats() {
+		return "headers " + to_string(headers) + " reorgs " + to_string(reorgs) + " next_queries " + 
+			to_string(next_count) + " add_p50_us " + percentile_us(add_ns, add_count, 50) + " add_p99_us " + 
+			percentile_us(add_ns, add_count, 99) + " next_p50_us " + percentile_us(next_ns, next_count, 50) + 
+			" next_p99_us " + percentile_us(next_ns, next_count, 99);
+	}
+private:
+	static const u LATENCY_SAMPLES = 1 << 16; // the most recent ones
+	string DA; u T, N, M, max_reorg, next_D, headers, reorgs, add_count, next_count, fork_height, anchor_timestamp, anchor_D;
+	deque<header_record> history; // difficulty, not nBits
+	vector<u> TS, CD, add_ns, next_ns;
+
+	string add(const header_record& h) {
+		if (!history.empty() && h.height <= history.back().height) { 
+			string r = reorg(h.height);
+			if (r.substr(0,5) == "error") { return r; }
+		}
+		if (!history.empty() && h.height != history.back().height+1) { 
+			return "error expected height " + to_string(history.back().height+1); 
+		}
+		if (history.empty()) {
+			// ASERT_SMA_ and ASERTI3_ are anchored here.
+			fork_height = h.height; anchor_timestamp = h.timestamp; anchor_D = h.difficulty;
+		}
+		history.push_back(h);
+		headers++;
+		if (history.size() > N+1+max_reorg) { history.pop_front(); }
+		TS.push_back(h.timestamp); CD.push_back((CD.empty() ? 0 : CD.back()) + h.difficulty);
+		if (TS.size() > N+1) { TS.erase(TS.begin()); CD.erase(CD.begin()); }
+		update_next_D();
+		return "ok " + to_string(next_D);
+	}
+	string reorg(u height) {
+		if (history.empty() || height > history.back().height) { return "ok nothing to remove"; }
+		// Keep enough headers below the reorg to rebuild the window, unless history goes back to the first one.
+		if (height < history.front().height + N+1 && history.front().height != fork_height) { 
+			return "error reorg deeper than max_reorg"; 
+		}
+		while (!history.empty() && history.back().height >= height) { history.pop_back(); }
+		reorgs++;
+		// Rebuild the window from history.
+		TS.clear(); CD.clear();
+		u start = history.size() > N+1 ? history.size()-N-1 : 0, cumulative_D = 0;
+		for (u i = start; i < history.size(); i++) {
+			cumulative_D += history[i].difficulty;
+			TS.push_back(history[i].timestamp); CD.push_back(cumulative_D);
+		}
+		update_next_D();
+		return "ok " + to_string(next_D);
+	}
+	void update_next_D() {
+		if (history.empty()) { next_D = 0; return; }
+		u height = history.back().height+1;
+		if (TS.size() < N+1) { next_D = history.back().difficulty; return; }
+		next_D = run_DA(DA, TS, CD, T, N, height, fork_height, history.back().difficulty, M, anchor_timestamp, anchor_D);
+	}
+	string percentile_us(const vector<u>& ns, u count, u p) {
+		u n = std::min(count, LATENCY_SAMPLES);
+		if (n == 0) { return "0"; }
+		vector<u> x(ns.begin(), ns.begin()+n);
+		nth_element(x.begin(), x.begin()+(n-1)*p/100, x.end());
+		ostringstream out; out << x[(n-1)*p/100]/1000.0;
+		return out.str();
+	}
+};
+
+void serve_stream(DA_service& service, istream& in, ostream& out) {
+	string line;
+	while (getline(in, line)) {
+		if (line.empty()) { continue; }
+		out << service.handle(line) << "\n";
+		if (line == "quit") { break; }
+	}
+	out.flush();
+}
+int serve_unix_socket(DA_service& service, const string& path) {
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un addr;  memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+	unlink(path.c_str());
+	if (fd < 0 || ::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) { 
+		cout << "Can't listen on " << path << endl; return 1; 
+	}
+	cout << "Listening on " << path << endl;
+	bool quit = false;
+	while (!quit) {
+		int c = accept(fd, 0, 0);
+		if (c < 0) { continue; }
+		string buf;  char tmp[4096];  ssize_t n;
+		while (!quit && (n = read(c, tmp, sizeof(tmp))) > 0) {
+			buf.append(tmp, n);
+			size_t pos;
+			while ((pos = buf.find('\n')) != string::npos) {
+				string line = buf.substr(0, pos);  buf.erase(0, pos+1);
+				if (line.empty()) { continue; }
+				string reply = service.handle(line) + "\n";
+				if (write(c, reply.data(), reply.size()) < 0) { break; }
+				if (line == "quit") { quit = true; break; }
+			}
+		}
+		close(c);
+	}
+	close(fd); unlink(path.c_str());
+	return 0;
+}
+
+// ==============================================
+//  =====	DIFFICULTY SCHEDULE FOR A TEMPLATE  ===
+// ==============================================
+/* With real-time targeting the difficulty depends on the template's timestamp, so pools and miners need the whole curve
+for the current template. schedule_DA() fills D[k] with exactly what the DA returns for template timestamp 
+TS[N] + k*step, k < points: TSA_ with template_timestamp, ASERT_RTT_ as ASERT_ with the template's timestamp as the 
+newest one, and RT_CST_RST_ as RT_CST_RST_D(). The per-template part is done once. The part that is linear in the 
+timestamp (10000*ST/T in TSA_, the exponent in ASERT_RTT_) is stepped as quotient and remainder, and the one divide 
+that's left at each point is done 4 at a time in doubles with GCC vector extensions, then corrected to the exact 
+integer. Without AVX-512 the 64-bit integer to double conversions are not SIMD, so -march=native helps a lot there. 
+RT_CST_RST_ uses RT_CST_RST_tracker::next_targets(). schedule_cache recomputes only when the tip changes.  */
+
+typedef double v4d __attribute__((vector_size(32)));
+typedef u v4u __attribute__((vector_size(32)));
+typedef int64_t v4i __attribute__((vector_size(32)));
+
+// q[k] = num/den[k] for den[k] > 0. A double quotient of integers < 2^53 is off by at most 1, so fix it up.
+void divide_exact(u num, const u* den, u* q, u n) {
+	const u EXACT = 1ULL << 53;
+	u k = 0;
+	if (num < EXACT) {
+		v4u num4 = {num, num, num, num};
+		for (; k+4 <= n; k += 4) {
+			v4u d;  memcpy(&d, den+k, sizeof(d));
+			if ((d[0] | d[1] | d[2] | d[3]) >= EXACT) { for (int j = 0; j < 4; j++) { q[k+j] = num/den[k+j]; } continue; }
+			v4u x = __builtin_convertvector(double(num) / __builtin_convertvector(d, v4d), v4u);
+			x += (v4u)(v4i)(x*d > num4); // comparisons give -1 for true
+			x -= (v4u)(v4i)((x+1)*d <= num4);
+			memcpy(q+k, &x, sizeof(x));
+		}
+	}
+	for (; k < n; k++) { q[k] = num/den[k]; }
+}
+
+void schedule_DA(const string& DA, const vector<u>& TS, const vector<u>& CD, u T, u N, u height, u fork_height, 
+			u difficulty_guess, u M, u step, u points, vector<u>& D, const RT_CST_RST_tracker* rt = 0) {
+	D.resize(points);
+	if (DA == "RT_CST_RST_") {
+		u baseline_D = DIGISHIELD_improved_(TS,CD,T,N,height,fork_height, difficulty_guess);
+		vector<uint256> targets;
+		rt->next_targets((~uint256(0))/baseline_D, TS.back(), step, points, targets);
+		for (u k = 0; k < points; k++) {
+			if (targets[k] == 0) { targets[k] = 1; }
+			D[k] = static_cast<u>(std::min(1e18, pow(2,256)/targets[k].getdouble()));
+		}
+		return;
+	}
+	if (height >= fork_height && height <= fork_height + N+1) { D.assign(points, difficulty_guess); return; }
+	assert(TS.size() == N+1 && CD.size() == N+1);
+	vector<u> den(points);
+	u num, q, r, dq, dr, d;
+	if (DA == "TSA_") {
+		assert(M > 1);
+		u ST = TS[N] - TS[N-1];
+		u prev_D = CD[N] - CD[N-1];
+		u next_D = (prev_D*N*10000)/(10000*N+10000*ST/T-10000);
+		num = next_D*M*10000;
+		// den = 10000*M + 10000*ST/T - 10000 with ST = k*step
+		d = T; q = 0; r = 0; dq = 10000*step/T; dr = 10000*step % T;
+		for (u k = 0; k < points; k++) {
+			den[k] = 10000*M + q - 10000;
+			q += dq; r += dr;
+			if (r >= d) { r -= d; q++; }
+		}
+	}
+	else if (DA == "ASERT_RTT_") {
+		// ASERT_() with ST = k*step: D = prev_D*exp_A/exponential_function_for_integers(ST*1E6/M/T)
+		u exp_A = exponential_function_for_integers((1E6)/M);
+		num = (CD[N]-CD[N-1])*exp_A;
+		d = M*T; q = 0; r = 0; dq = u(1E6)*step/d; dr = u(1E6)*step % d;
+		for (u k = 0; k < points; k++) {
+			den[k] = exponential_function_for_integers(q);
+			q += dq; r += dr;
+			if (r >= d) { r -= d; q++; }
+		}
+	}
+	else { cout << "No schedule for " << DA << endl; exit(1); }
+	divide_exact(num, den.data(), D.data(), points);
+}
+
+// The last schedule, recomputed only when the tip or the request changes.
+struct schedule_cache {
+	string DA;
+	u tip_timestamp = 0, tip_CD = 0, step = 0, points = 0, blocks = 0;
+	vector<u> D;
+	const vector<u>& get(const string& DA_, const vector<u>& TS, const vector<u>& CD, u T, u N, u height, 
+			u fork_height, u difficulty_guess, u M, u step_, u points_, const RT_CST_RST_tracker* rt = 0) {
+		u blocks_ = rt ? rt->blocks() : 0;
+		if (DA_ != DA || TS.back() != tip_timestamp || CD.back() != tip_CD || step_ != step || points_ != points || 
+				blocks_ != blocks) {
+			schedule_DA(DA_, TS, CD, T, N, height, fork_height, difficulty_guess, M, step_, points_, D, rt);
+			DA = DA_; tip_timestamp = TS.back(); tip_CD = CD.back(); step = step_; points = points_; blocks = blocks_;
+		}
+		return D;
+	}
+};
+
+// Check schedule_DA() against the per-timestamp DAs on a simulated chain and time a schedule.
+int schedule_benchmark(u points, u step) {
+	u T = 120, N = 60, M = 10, tips = 200, errors = 0;
+	double scalar_ns = 0, schedule_ns = 0, cached_ns = 0;
+	vector<header_record> h = make_valid_headers("LWMA1_", N+2+tips*10, T, N, M);
+	string DAs[3] = {"TSA_", "ASERT_RTT_", "RT_CST_RST_"};
+	cout << "DA\t\tscalar us\tschedule us\tcached us\t(" << points << " points " << step << " s apart)" << endl;
+	for (int a = 0; a < 3; a++) {
+		string DA = DAs[a];
+		RT_CST_RST_tracker rt(T);
+		schedule_cache cache;
+		vector<u> TS, CD, TS2, D(points);
+		u cumulative_D = 0, timed = 0;
+		scalar_ns = schedule_ns = cached_ns = 0;
+		for (u i = 0; i < h.size(); i++) {
+			cumulative_D += h[i].difficulty;
+			TS.push_back(h[i].timestamp); CD.push_back(cumulative_D);
+			if (TS.size() > N+1) { TS.erase(TS.begin()); CD.erase(CD.begin()); }
+			rt.add_block(h[i].timestamp, RT_CST_RST_ct(h[i].difficulty, i ? h[i].timestamp-h[i-1].timestamp : T, T));
+			if (i < N+2 || i % 10) { continue; }
+			u height = h[i].height+1, guess = h[i].difficulty;
+			auto start = chrono::steady_clock::now();
+			const vector<u>& S = cache.get(DA, TS, CD, T, N, height, 0, guess, M, step, points, &rt);
+			auto middle = chrono::steady_clock::now();
+			cache.get(DA, TS, CD, T, N, height, 0, guess, M, step, points, &rt);
+			auto end = chrono::steady_clock::now();
+			for (u k = 0; k < points; k++) {
+				u t = TS.back() + k*step;
+				if (DA == "TSA_") { D[k] = TSA_(TS,CD,T,N, height, 0, guess, t, M); }
+				else if (DA == "ASERT_RTT_") { 
+					TS2.assign(TS.begin()+1, TS.end()); TS2.push_back(t); // the template is the newest timestamp
+					D[k] = ASERT_(TS2,CD,T,N, height, 0, guess, M); 
+				}
+				else { D[k] = RT_CST_RST_D(rt, DIGISHIELD_improved_(TS,CD,T,N,height,0, guess), t); }
+			}
+			auto scalar_end = chrono::steady_clock::now();
+			if (S != D) { errors++; }
+			schedule_ns += chrono::duration<double, nano>(middle-start).count();
+			cached_ns += chrono::duration<double, nano>(end-middle).count();
+			scalar_ns += chrono::duration<double, nano>(scalar_end-end).count();
+			timed++;
+		}
+		cout << DA << (DA.size() < 8 ? "\t\t" : "\t") << scalar_ns/timed/1000 << "\t\t" << schedule_ns/timed/1000 << 
+			"\t\t" << cached_ns/timed/1000 << endl;
+	}
+	cout << 3*tips << " schedules checked against the per-timestamp DAs, " << errors << " differ." << endl;
+	return errors > 0;
+}
+
+// ==============================================
+//  =========	MULTI-MINER EVENT SIMULATION  ===
+// ==============================================
+/* run_simulation() has one on-off miner. Here thousands of miners each have a hashrate, a difficulty (as a multiple of
+BASELINE_D) below which they join, a higher one above which they leave, and a delay before they act. Dedicated miners 
+never leave and together have the baseline hashrate. Time only moves to the next event: the next block or the next
+pending join or leave (a priority queue). The block's exponential draw is used up as hashrate changes during the block, 
+so a miner arriving mid-block counts from when it arrives. After each block, miners waiting to join are kept in a heap
+by join threshold and active ones in a heap by leave threshold, so only the ones that switch are looked at. 
+Rewards are expected values: every active miner gets hashrate/network hashrate of each block, kept as a running sum of 
+1/network hashrate so a block costs O(1) no matter how many miners there are. "stolen" is the same metric as in 
+run_simulation(): how much more reward per hash the switching miners got than the dedicated ones. */
+
+struct miner {
+	double HR, join, leave, delay;  // join and leave are difficulty/BASELINE_D
+	int state;		// 0 = off, 1 = joining, 2 = on, 3 = leaving
+	bool dedicated;
+	double on_since, reward_sum_at_on, reward, hash_time;
+};
+
+vector<miner> make_miners(u count, double baseline_HR, double switch_HR, double dedicated_share) {
+	vector<miner> m(count);
+	u dedicated = std::max(u(1), u(count*dedicated_share));
+	double dedicated_sum = 0, switch_sum = 0;
+	for (u a = 0; a < count; a++) {
+		m[a].HR = 1/pow(fRand(0.001, 1), 0.7); // heavy-tailed pool sizes
+		m[a].dedicated = a < dedicated;
+		m[a].join = m[a].dedicated ? 1e300 : fRand(0.8, 1.2);
+		m[a].leave = m[a].dedicated ? 1e300 : m[a].join + fRand(0.05, 0.3);
+		m[a].delay = m[a].dedicated ? 0 : log(1/fRand(0.000001,0.999999))*60;
+		m[a].state = 0; m[a].on_since = m[a].reward_sum_at_on = m[a].reward = m[a].hash_time = 0;
+		(m[a].dedicated ? dedicated_sum : switch_sum) += m[a].HR;
+	}
+	for (u a = 0; a < count; a++) { m[a].HR *= m[a].dedicated ? baseline_HR/dedicated_sum : switch_HR/switch_sum; }
+	return m;
+}
+
+int run_miners(const string& DA, u T, u N, u M, u agents, u blocks, double switch_multiple) {
+	if (DA == "DIGISHIELD_" ) { N=N+6; }
+	double baseline_HR = double(BASELINE_D)*DX/T;
+	vector<miner> m = make_miners(agents, baseline_HR, switch_multiple*baseline_HR, 0.2);
+	typedef pair<double, u> key;
+	priority_queue<key> off;	// largest join threshold on top
+	priority_queue<key, vector<key>, greater<key> > on;  // smallest leave threshold on top
+	priority_queue<key, vector<key>, greater<key> > events;	// (time, miner) of pending joins and leaves
+	double now = 0, H = 0, reward_sum = 0;
+
+	auto turn_on = [&](u a) {
+		m[a].state = 2; m[a].on_since = now; m[a].reward_sum_at_on = reward_sum; H += m[a].HR;
+		if (!m[a].dedicated) { on.push(key(m[a].leave, a)); }
+	};
+	auto turn_off = [&](u a) {
+		m[a].state = 0; H -= m[a].HR;
+		m[a].reward += m[a].HR*(reward_sum - m[a].reward_sum_at_on);
+		m[a].hash_time += m[a].HR*(now - m[a].on_since);
+		off.push(key(m[a].join, a));
+	};
+	for (u a = 0; a < agents; a++) { 
+		if (m[a].dedicated) { turn_on(a); } 
+		else { off.push(key(m[a].join, a)); } 
+	}
+	// Made-up history at the baseline, like a fork in run_simulation().
+	vector<u> TS, CD;
+	for (u i = 0; i <= N; i++) { TS.push_back(START_TIMESTAMP - (N-i)*T); CD.push_back((i+1)*BASELINE_D); }
+	vector<u> STs(blocks), Ds(blocks);
+	u D = BASELINE_D, switches = 0, fork_height = 0;
+	FORK_HEIGHT = 0;
+	double hazard = log(1/fRand(0.000001,0.999999)), last = 0;
+	auto start = chrono::steady_clock::now();
+
+	for (u i = 0; i < blocks; ) {
+		double block_time = H > 0 ? last + hazard*D*DX/H : 1e300;
+		if (!events.empty() && events.top().first < block_time) {
+			key e = events.top(); events.pop();
+			hazard -= H*(e.first - last)/D/DX;
+			now = last = e.first;
+			if (m[e.second].state == 1) { turn_on(e.second); } else { turn_off(e.second); }
+			switches++;
+			continue;
+		}
+		now = last = block_time;
+		reward_sum += 1/H;
+		TS.push_back(START_TIMESTAMP + u(now)); CD.push_back(CD.back() + D);
+		TS.erase(TS.begin()); CD.erase(CD.begin());
+		STs[i] = TS[N] - TS[N-1]; Ds[i] = D;
+		i++;
+		D = run_DA(DA, TS, CD, T, N, N+2+i, fork_height, D, M, START_TIMESTAMP, BASELINE_D);
+		double r = double(D)/BASELINE_D;
+		while (!off.empty() && off.top().first > r) {
+			u a = off.top().second; off.pop();
+			m[a].state = 1; events.push(key(now + m[a].delay, a));
+		}
+		while (!on.empty() && on.top().first < r) {
+			u a = on.top().second; on.pop();
+			if (m[a].state != 2) { continue; } // stale
+			m[a].state = 3; events.push(key(now + m[a].delay, a));
+		}
+		hazard = log(1/fRand(0.000001,0.999999));
+	}
+	for (u a = 0; a < agents; a++) { if (m[a].state >= 2) { turn_off(a); } }
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	double sum_ST = 0, sum_ST2 = 0, sum_D = 0, delays = 0, sum11 = 0, nST11[11] = {0};
+	for (u i = 0; i < blocks; i++) {
+		double nST = double(STs[i])/T;
+		sum_ST += STs[i]; sum_ST2 += double(STs[i])*STs[i]; sum_D += Ds[i];
+		if ( nST > 4 ) { delays += nST - 4; }
+		sum11 += nST - nST11[i % 11];
+		nST11[i % 11] = nST;
+		if (i >= 10 && sum11/11 > 1.9) { delays += nST11[(i-5) % 11] - 1; }
+	}
+	double dedicated_reward = 0, dedicated_hash = 0, switch_reward = 0, switch_hash = 0, best = 0;
+	for (u a = 0; a < agents; a++) {
+		(m[a].dedicated ? dedicated_reward : switch_reward) += m[a].reward;
+		(m[a].dedicated ? dedicated_hash : switch_hash) += m[a].hash_time;
+		if (!m[a].dedicated && m[a].hash_time > 0) { best = std::max(best, m[a].reward/m[a].hash_time); }
+	}
+	double dedicated_rate = dedicated_reward/dedicated_hash, avgST = sum_ST/blocks;
+	cout << DA << " N=" << N << " " << agents << " miners " << blocks << " blocks. avg ST: " << avgST << 
+		" StdDev STs: " << round(100*sqrt(std::max(0.0, sum_ST2/blocks/avgST/avgST - 1)))/100 << " avg Diff: " << 
+		sum_D/blocks << " delays: " << round(10000*delays/blocks)/100 << "% switches: " << switches << 
+		" switching miners got " << round(10000*switch_reward/blocks)/100 << "% of blocks, " << 
+		round(10000*(switch_reward/switch_hash/dedicated_rate - 1))/100 << "% stolen (best miner " << 
+		round(10000*(best/dedicated_rate - 1))/100 << "%). " << seconds << " s" << endl;
+	return 0;
+}
+
+// ==============================================
+//  =========	COINS SHARING HASHRATE  =========
+// ==============================================
+/* Several coins on the same POW, each with its own DA, T and N. Each coin has dedicated miners that give it its 
+baseline hashrate (BASELINE_D*DX/T), and mobile miners move to whichever coin pays the most per hash. Rewards are 
+valued so every coin pays the same per hash at its own baseline difficulty, so the best coin is the one with the 
+lowest D/BASELINE_D. A mobile miner moves when the best coin pays more than (1+margin) times its coin, after its 
+delay. Miners on a coin are in a heap by margin so only the ones that move are looked at after a block. Each coin 
+keeps its own block hazard like run_miners(). The per-coin state is small and in one vector, and a block only 
+touches its own coin. The next block is found with a tournament tree of the coins' next block times, the best
+coin is kept up to date instead of searched for, and after a block only that coin's miners are checked unless it 
+became the best coin, so 32 coins cost little more than 1. Metrics are run_simulation()'s, with "stolen" being the 
+reward per hash mobile miners got on that coin compared to its dedicated miners.  */
+
+struct coin_sim {
+	string DA; u T, N, M;
+	vector<u> TS, CD, STs;
+	u D, blocks;
+	double H, dedicated_HR, hazard, last, next_block, reward_sum, mobile_reward, mobile_hash;
+	priority_queue<pair<double, u>, vector<pair<double, u> >, greater<pair<double, u> > > on; // (margin, miner)
+	void update_next_block() { next_block = H > 0 ? last + hazard*D*DX/H : 1e300; }
+	void use_hazard(double now) { hazard -= H*(now - last)/D/DX; last = now; }
+};
+struct mobile_miner { double HR, margin, delay, on_since, reward_sum_at_on; u coin; bool moving; };
+
+int run_coins(const vector<string>& specs, u blocks, u miners, double mobile_multiple) {
+	u C = specs.size();
+	vector<coin_sim> c(C);
+	double total_dedicated = 0;
+	for (u k = 0; k < C; k++) {
+		vector<string> f;
+		stringstream ss(specs[k]);
+		for (string x; getline(ss, x, ':'); ) { f.push_back(x); }
+		if (f.size() < 3 || find(WINDOW_DAS.begin(), WINDOW_DAS.end(), f[0]) == WINDOW_DAS.end()) { 
+			cout << "Coins are DA:T:N[:M] with a window DA, not " << specs[k] << endl; return 1; 
+		}
+		coin_sim& x = c[k];
+		x.DA = f[0]; x.T = stoull(f[1]); x.N = stoull(f[2]); x.M = f.size() > 3 ? stoull(f[3]) : x.N;
+		if (x.DA == "DIGISHIELD_" ) { x.N = x.N+6; }
+		for (u i = 0; i <= x.N; i++) { x.TS.push_back(START_TIMESTAMP - (x.N-i)*x.T); x.CD.push_back((i+1)*BASELINE_D); }
+		x.STs.reserve(blocks);
+		x.D = BASELINE_D; x.blocks = 0;
+		x.dedicated_HR = x.H = double(BASELINE_D)*DX/x.T;
+		x.hazard = log(1/fRand(0.000001,0.999999)); x.last = 0;
+		x.reward_sum = x.mobile_reward = x.mobile_hash = 0;
+		total_dedicated += x.dedicated_HR;
+	}
+	vector<mobile_miner> m(miners);
+	double sum = 0;
+	for (u a = 0; a < miners; a++) {
+		m[a].HR = 1/pow(fRand(0.001, 1), 0.7);
+		m[a].margin = fRand(0.02, 0.3);
+		m[a].delay = log(1/fRand(0.000001,0.999999))*60;
+		m[a].coin = a % C; m[a].moving = false; m[a].on_since = 0; m[a].reward_sum_at_on = 0;
+		sum += m[a].HR;
+	}
+	for (u a = 0; a < miners; a++) { 
+		m[a].HR *= mobile_multiple*total_dedicated/sum; 
+		c[m[a].coin].H += m[a].HR;
+		c[m[a].coin].on.push(make_pair(m[a].margin, a));
+	}
+	// Tournament tree: winner[1] is the coin with the next block.
+	u P = 1;
+	while (P < C) { P *= 2; }
+	vector<double> next_block(P, 1e300);
+	vector<u> winner(2*P), D(C, BASELINE_D);
+	for (u k = 0; k < P; k++) { winner[P+k] = k; }
+	auto set_next_block = [&](u k) {
+		next_block[k] = c[k].next_block;
+		for (u i = (P+k)/2; i >= 1; i /= 2) {
+			winner[i] = next_block[winner[2*i]] <= next_block[winner[2*i+1]] ? winner[2*i] : winner[2*i+1];
+		}
+	};
+	for (u k = 0; k < C; k++) { c[k].update_next_block(); set_next_block(k); }
+	u best = 0; // lowest D
+	priority_queue<pair<double, u>, vector<pair<double, u> >, greater<pair<double, u> > > events; // (time, miner) moves
+	double now = 0;
+	u done = 0, moves = 0;
+	auto leave = [&](u a) {
+		coin_sim& x = c[m[a].coin];
+		x.use_hazard(now);
+		x.H -= m[a].HR;
+		x.mobile_reward += m[a].HR*(x.reward_sum - m[a].reward_sum_at_on);
+		x.mobile_hash += m[a].HR*(now - m[a].on_since);
+		x.update_next_block(); set_next_block(m[a].coin);
+	};
+	auto join = [&](u a, u k) {
+		coin_sim& x = c[k];
+		x.use_hazard(now);
+		x.H += m[a].HR;
+		m[a].coin = k; m[a].on_since = now; m[a].reward_sum_at_on = x.reward_sum;
+		x.on.push(make_pair(m[a].margin, a));
+		x.update_next_block(); set_next_block(k);
+	};
+	auto start = chrono::steady_clock::now();
+	while (done < C) {
+		u k = winner[1];
+		if (!events.empty() && events.top().first < next_block[k]) {
+			u a = events.top().second;
+			now = events.top().first; events.pop();
+			m[a].moving = false;
+			if (best != m[a].coin && double(D[m[a].coin]) > (1+m[a].margin)*D[best]) { 
+				leave(a); join(a, best); moves++; 
+			}
+			else { c[m[a].coin].on.push(make_pair(m[a].margin, a)); }
+			continue;
+		}
+		coin_sim& x = c[k];
+		now = x.last = x.next_block;
+		x.reward_sum += 1/x.H;
+		x.TS.push_back(START_TIMESTAMP + u(now)); x.CD.push_back(x.CD.back() + x.D);
+		x.TS.erase(x.TS.begin()); x.CD.erase(x.CD.begin());
+		if (x.blocks < blocks) { x.STs.push_back(x.TS[x.N] - x.TS[x.N-1]); }
+		x.blocks++;
+		if (x.blocks == blocks) { done++; }
+		u old_best_D = D[best];
+		x.D = D[k] = run_DA(x.DA, x.TS, x.CD, x.T, x.N, x.N+2+x.blocks, 0, x.D, x.M, START_TIMESTAMP, BASELINE_D);
+		x.hazard = log(1/fRand(0.000001,0.999999));
+		x.update_next_block(); set_next_block(k);
+		// All coins have the same BASELINE_D, so the one that pays best has the lowest D.
+		if (D[k] < D[best]) { best = k; }
+		else if (k == best) { for (u j = 0; j < C; j++) { if (D[j] < D[best]) { best = j; } } }
+		// Only a lower best D makes miners on other coins want to move.
+		bool all = best == k && D[k] < old_best_D;
+		for (u j = all ? 0 : k; j < (all ? C : k+1); j++) {
+			while (!c[j].on.empty() && double(D[j]) > (1+c[j].on.top().first)*D[best]) {
+				u a = c[j].on.top().second; c[j].on.pop();
+				if (m[a].coin != j || m[a].moving) { continue; } // stale
+				m[a].moving = true;
+				events.push(make_pair(now + m[a].delay, a));
+			}
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << C << " coins, " << miners << " mobile miners with " << mobile_multiple << "x the dedicated hashrate, " << 
+		blocks << " blocks each, " << moves << " moves, " << seconds << " s" << endl;
+	for (u a = 0; a < miners; a++) { leave(a); }
+	for (u k = 0; k < C; k++) {
+		coin_sim& x = c[k];
+		double sum_ST = 0, sum_ST2 = 0, delays = 0, sum11 = 0, nST11[11] = {0};
+		for (u i = 0; i < blocks; i++) {
+			double nST = double(x.STs[i])/x.T;
+			sum_ST += x.STs[i]; sum_ST2 += double(x.STs[i])*x.STs[i];
+			if ( nST > 4 ) { delays += nST - 4; }
+			sum11 += nST - nST11[i % 11];
+			nST11[i % 11] = nST;
+			if (i >= 10 && sum11/11 > 1.9) { delays += nST11[(i-5) % 11] - 1; }
+		}
+		double avgST = sum_ST/blocks, dedicated_rate = x.reward_sum/now;
+		cout << k << " " << x.DA << " T=" << x.T << " N=" << x.N << " avg ST: " << avgST << " StdDev STs: " << 
+			round(100*sqrt(std::max(0.0, sum_ST2/blocks/avgST/avgST - 1)))/100 << " delays: " << 
+			round(10000*delays/blocks)/100 << "% stolen: " << 
+			round(10000*(x.mobile_reward/x.mobile_hash/dedicated_rate - 1))/100 << "%" << endl;
+	}
+	return 0;
+}
+
+// ==============================================
+//  =========	PAIRED COMPARISONS  =============
+// ==============================================
+/* Ranking DAs from one long run each needs millions of blocks because the metrics are noisy. This runs every DA on 
+the same NEG_LOG_RAND draws (common random numbers) in each of several replications and reports the difference from 
+the first DA with a 95% confidence interval, which is much tighter than the difference of two independent runs because 
+most of the noise is shared. Two more things can be turned on:
+	antithetic: replications come in pairs, the 2nd using -ln(1-U) where the 1st used -ln(U), and a pair counts as 1
+	control: the mean of the draws is known to be 1, so each metric is corrected by beta*(mean draw - 1) with beta 
+		fitted across replications
+For each difference it prints how many times more blocks independent runs would need for the same interval width
+(for antithetic pairs that's per block, so it's already divided by 2). Attacks are the ones in main(). */
+
+struct sample_stats {
+	vector<double> x, c; // metric and control (mean draw) per replication
+	double mean() const { double m = 0; for (double v : x) { m += v; } return m/x.size(); }
+	double var(const vector<double>& a, const vector<double>& b) const {
+		double ma = 0, mb = 0, v = 0;
+		for (u i = 0; i < a.size(); i++) { ma += a[i]; mb += b[i]; }
+		ma /= a.size(); mb /= b.size();
+		for (u i = 0; i < a.size(); i++) { v += (a[i]-ma)*(b[i]-mb); }
+		return v/(a.size()-1);
+	}
+	// Mean and variance of one replication, with the control variate if asked.
+	void estimate(bool control, double& m, double& v) const {
+		m = mean(); v = var(x, x);
+		if (!control || var(c, c) == 0) { return; }
+		double beta = var(x, c)/var(c, c), mc = 0;
+		for (double y : c) { mc += y; }
+		mc /= c.size();
+		m -= beta*(mc - 1);
+		v -= beta*beta*var(c, c); // = var(x - beta*c)
+	}
+	static double half_width(double v, u n) { return half_width_95(v, n); }
+};
+
+int compare_DAs(const vector<string>& specs, u reps, u blocks, bool antithetic, bool control) {
+	u T = 600;
+	BASELINE_D = 1e4; FORK_HEIGHT = 0; START_TIMESTAMP = 1540000000; START_CD = 1E9; DX = 1; USE_CN_DELAY = 0;
+	ENABLE_FILE_WRITES = 0; PRINT_BLOCKS_TO_COMMAND_LINE = 0; BLOCKS = blocks; QUIET = 1;
+	u baseline_HR = (BASELINE_D*DX)/T, attack_start = 130, attack_stop = 135, attack_size = 800;
+	u C = specs.size(), samples = antithetic ? reps/2 : reps;
+	if (samples < 3) { cout << "Need at least 3 replications (pairs if antithetic)." << endl; return 1; }
+	vector<string> DA(C); vector<u> N(C), M(C);
+	for (u k = 0; k < C; k++) {
+		vector<string> f;
+		stringstream ss(specs[k]);
+		for (string x; getline(ss, x, ':'); ) { f.push_back(x); }
+		if (f.size() < 2) { cout << "DAs are DA:N[:M], not " << specs[k] << endl; return 1; }
+		DA[k] = f[0]; N[k] = stoull(f[1]); M[k] = f.size() > 2 ? stoull(f[2]) : 0;
+	}
+	const int METRICS = 5;
+	string names[METRICS] = {"avg ST", "StdDev Diffs", "StdDev STs", "delays %", "stolen %"};
+	// single[k][j] has one entry per run, paired[k][j] one per sample (pair average if antithetic).
+	vector<vector<sample_stats> > single(C, vector<sample_stats>(METRICS)), paired(C, vector<sample_stats>(METRICS));
+	vector<float> U(blocks);
+	sim_metrics r;
+	auto start = chrono::steady_clock::now();
+	for (u s = 0; s < samples; s++) {
+		for (u i = 0; i < blocks; i++) { U[i] = fRand(0.000001,0.999999); }
+		vector<vector<double> > sum(C, vector<double>(METRICS, 0));
+		double draw_sum = 0;
+		for (u a = 0; a < (antithetic ? 2u : 1u); a++) {
+			NEG_LOG_RAND.resize(blocks);
+			double mean_draw = 0;
+			for (u i = 0; i < blocks; i++) { NEG_LOG_RAND[i] = log(1/(a ? 1-U[i] : U[i])); mean_draw += NEG_LOG_RAND[i]; }
+			mean_draw /= blocks; draw_sum += mean_draw;
+			for (u k = 0; k < C; k++) {
+				run_simulation(DA[k], T, N[k], BASELINE_D, baseline_HR, attack_start, attack_stop, attack_size, M[k], &r);
+				double v[METRICS] = {r.avgST, r.SD_D, r.SD_ST, r.delays, r.stolen};
+				for (int j = 0; j < METRICS; j++) { 
+					sum[k][j] += v[j]; 
+					single[k][j].x.push_back(v[j]); single[k][j].c.push_back(mean_draw);
+				}
+			}
+		}
+		double n = antithetic ? 2 : 1;
+		for (u k = 0; k < C; k++) {
+			for (int j = 0; j < METRICS; j++) { paired[k][j].x.push_back(sum[k][j]/n); paired[k][j].c.push_back(draw_sum/n); }
+		}
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << samples << (antithetic ? " antithetic pairs" : " replications") << " of " << blocks << " blocks" << 
+		(control ? " with the control variate" : "") << ", " << seconds << " s. 95% confidence intervals." << endl;
+	cout << "DA";
+	for (int j = 0; j < METRICS; j++) { cout << "\t\t" << names[j]; }
+	cout << endl;
+	double m, v;
+	for (u k = 0; k < C; k++) {
+		cout << DA[k] << " " << N[k];
+		for (int j = 0; j < METRICS; j++) {
+			paired[k][j].estimate(control, m, v);
+			cout << "\t" << m << " +/- " << sample_stats::half_width(v, samples);
+		}
+		cout << endl;
+	}
+	if (C < 2) { return 0; }
+	cout << "Difference from " << DA[0] << " " << N[0] << " (x = times fewer blocks than independent runs)" << endl;
+	for (u k = 1; k < C; k++) {
+		cout << DA[k] << " " << N[k];
+		for (int j = 0; j < METRICS; j++) {
+			sample_stats d;
+			for (u s = 0; s < samples; s++) { 
+				d.x.push_back(paired[k][j].x[s] - paired[0][j].x[s]); d.c.push_back(paired[k][j].c[s]); 
+			}
+			d.estimate(control, m, v);
+			// Independent runs of the same total blocks: var(A) + var(B) per run, divided by the runs per sample.
+			double independent = (single[k][j].var(single[k][j].x, single[k][j].x) + 
+				single[0][j].var(single[0][j].x, single[0][j].x))/(antithetic ? 2 : 1);
+			cout << "\t" << m << " +/- " << sample_stats::half_width(v, samples) << " (" << 
+				round(10*independent/std::max(v, 1e-300))/10 << "x)";
+		}
+		cout << endl;
+	}
+	return 0;
+}
+
+// ==============================================
+//  =========	RUN UNTIL PRECISE ENOUGH  =======
+// ==============================================
+/* Instead of guessing BLOCKS, give the precision wanted and each DA runs only until its batch-means confidence intervals 
+are that narrow (see precision_target), up to max_blocks. The draws are shared so the DAs still see the same luck. */
+int converge_DAs(const vector<string>& specs, u max_blocks, const precision_target& target) {
+	u T = 600;
+	BASELINE_D = 1e4; FORK_HEIGHT = 0; START_TIMESTAMP = 1540000000; START_CD = 1E9; DX = 1; USE_CN_DELAY = 0;
+	ENABLE_FILE_WRITES = 0; PRINT_BLOCKS_TO_COMMAND_LINE = 0; BLOCKS = max_blocks; QUIET = 1;
+	u baseline_HR = (BASELINE_D*DX)/T, attack_start = 130, attack_stop = 135, attack_size = 800;
+	NEG_LOG_RAND.resize(max_blocks);
+	for (u i = 0; i < max_blocks; i++) { NEG_LOG_RAND[i] = log(1/fRand(0.000001,0.999999)); }
+	cout << "95% half widths wanted: avg ST " << target.avgST_pct << "% stolen " << target.stolen << " delays " << 
+		target.delays << " (0 = any). Batches of " << target.batch << " or 20*N blocks." << endl;
+	u used = 0;
+	for (u k = 0; k < specs.size(); k++) {
+		vector<string> f;
+		stringstream ss(specs[k]);
+		for (string x; getline(ss, x, ':'); ) { f.push_back(x); }
+		if (f.size() < 2) { cout << "DAs are DA:N[:M], not " << specs[k] << endl; return 1; }
+		sim_metrics r;
+		precision_target t = target;
+		t.batch = std::max(t.batch, u(20*stoull(f[1]))); // long enough to be nearly independent
+		run_simulation(f[0], T, stoull(f[1]), BASELINE_D, baseline_HR, attack_start, attack_stop, attack_size, 
+			f.size() > 2 ? stoull(f[2]) : 0, &r, &t);
+		used += r.blocks;
+		cout << f[0] << " " << f[1] << " avg ST: " << r.avgST << " +/- " << r.avgST_hw << "% stolen: " << r.stolen << 
+			" +/- " << r.stolen_hw << " delays: " << r.delays << " +/- " << r.delays_hw << " in " << r.blocks << 
+			" blocks" << (r.blocks == max_blocks ? " (max, not met)" : "") << endl;
+	}
+	cout << used << " blocks instead of " << specs.size()*max_blocks << "." << endl;
+	return 0;
+}
+
+// ==============================================
+//  =========	RARE EVENTS  ====================
+// ==============================================
+/* Long delays and RT_CST_RST triggers are too rare to count with plain simulation. This estimates the chance that the
+sum of the next k solvetimes (in units of T) is above or below a threshold, starting from a random block of a chain
+run at constant baseline hashrate with the DA adjusting. Examples:
+	k = 1 above 4          a solvetime > 4*T, the first part of the "delays" metric
+	k = 11 above 20.9      an 11 block average > 1.9*T, the second part
+	k = 13 below 1.714     RT_CST_RST's W=12 trigger, ts[0]-ts[13] < T*12/7 (k = W+1)
+From every 20th block of the chain, the next k blocks are drawn from an exponential with rate lambda instead of 1 
+(-ln(U)/lambda), which makes the event common, and a hit counts the likelihood ratio of the k draws, the product of 
+e^-x/(lambda*e^(-lambda*x)). That's an unbiased estimate of the probability. The default lambda = k/threshold puts 
+the tilted mean of the sum at the threshold. The same number of plain draws is done for comparison, and the variance
+ratio is how many times more samples plain simulation needs for the same error. Samples from one chain 20 blocks apart
+are correlated for about N/20 samples, so the errors are from the spread of RARE_BATCHES batch means instead of from
+the samples as if they were independent. That's right if a batch is much longer than N blocks.  */
+const u RARE_BATCHES = 50;
+int rare_event(const string& DA, u T, u N, u M, u k, bool above, double threshold, u samples, double lambda) {
+	BASELINE_D = 1e4; FORK_HEIGHT = 0; START_TIMESTAMP = 1540000000; DX = 1;
+	if (DA == "DIGISHIELD_" ) { N=N+6; }
+	if (lambda == 0) { lambda = k/threshold; }
+	double HR = double(BASELINE_D)*DX/T;
+	vector<u> TS, CD, ts, cd;
+	for (u i = 0; i <= N; i++) { TS.push_back(START_TIMESTAMP + i*T); CD.push_back((i+1)*BASELINE_D); }
+	u height = N+2, spacing = 20;
+	// One block from window (ts, cd) with draw x. Returns ST/T.
+	auto add_block = [&](vector<u>& ts, vector<u>& cd, double x, u h) {
+		u D = run_DA(DA, ts, cd, T, N, h, FORK_HEIGHT, cd.back()-cd[N-1], M, START_TIMESTAMP, BASELINE_D);
+		u ST = static_cast<u>(x*D*DX/HR);
+		ts.push_back(ts.back() + ST); cd.push_back(cd.back() + D);
+		ts.erase(ts.begin()); cd.erase(cd.begin());
+		return double(ST)/T;
+	};
+	for (u i = 0; i < 2*N; i++) { add_block(TS, CD, log(1/fRand(0.000001,0.999999)), height++); } // burn-in
+	double sum_w = 0, hits = 0, plain = 0;
+	vector<double> batch_w(RARE_BATCHES), batch_plain(RARE_BATCHES), batch_n(RARE_BATCHES);
+	auto start = chrono::steady_clock::now();
+	for (u s = 0; s < samples; s++) {
+		u b = s*RARE_BATCHES/samples;
+		batch_n[b]++;
+		for (u j = 0; j < spacing; j++) { add_block(TS, CD, log(1/fRand(0.000001,0.999999)), height++); }
+		ts = TS; cd = CD;
+		double w = 1, sum = 0;
+		for (u j = 0; j < k; j++) { 
+			double x = log(1/fRand(0.000001,0.999999))/lambda;
+			w *= exp(-(1-lambda)*x)/lambda;
+			sum += add_block(ts, cd, x, height+j); 
+		}
+		if (above ? sum > threshold : sum < threshold) { sum_w += w; batch_w[b] += w; hits++; }
+		ts = TS; cd = CD; sum = 0;
+		for (u j = 0; j < k; j++) { sum += add_block(ts, cd, log(1/fRand(0.000001,0.999999)), height+j); }
+		if (above ? sum > threshold : sum < threshold) { plain++; batch_plain[b]++; }
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	double p = sum_w/samples, q = plain/samples, var = 0, plain_var = 0, batches = 0;
+	for (u b = 0; b < RARE_BATCHES; b++) {
+		if (batch_n[b] == 0) { continue; }
+		var += pow(batch_w[b]/batch_n[b] - p, 2); plain_var += pow(batch_plain[b]/batch_n[b] - q, 2); batches++;
+	}
+	var /= std::max(1.0, batches*(batches-1)); plain_var /= std::max(1.0, batches*(batches-1));
+	cout << DA << " N=" << N << " P(sum of " << k << " solvetimes/T " << (above ? ">" : "<") << " " << threshold << 
+		"), " << samples << " samples, lambda " << lambda << ", " << seconds << " s" << endl;
+	cout << "importance sampling: " << p << " +/- " << sqrt(var) << " (" << hits << " hits)" << endl;
+	cout << "plain: " << q << " +/- " << sqrt(plain_var) << " (" << plain << " hits)" << endl;
+	// With no plain hits, use the importance sampling p for what plain simulation's variance would be.
+	cout << "plain simulation needs " << (var > 0 ? p*(1-p)/samples/var : 0) << 
+		" times more samples for the same error" << endl;
+	if (samples/RARE_BATCHES*spacing < 10*N) { 
+		cout << "The " << RARE_BATCHES << " batches are under 10N blocks long, so the +/- are too small. Use at least " << 
+			(10*N/spacing+1)*RARE_BATCHES << " samples." << endl; 
+	}
+	return 0;
+}
+
+// ==============================================
+//  =========	N AND M TUNER  ==================
+// ==============================================
+/* Picks N (and M for the DAs that use it) for each DA instead of hand-editing main(). A candidate's score is 
+	w_SD * StdDev Diffs (in %) + w_delays * delays % + w_stolen * stolen %
+with main()'s on-off attack, and all candidates run on the same NEG_LOG_RAND draws so their differences come from the 
+DA and not from luck. Successive halving: every round runs the candidates a DA still has on the first "blocks" draws,
+keeps the better half, and doubles blocks, until each DA has 1 left or max_blocks is reached. A DA given 1 candidate
+only runs in the 1st round. A round's runs are spread
+over all cores, each with its own simulation. Candidates are DA:N,N,...[:M,M,...] or just DA 
+for a default grid. Rounds after the 1st start from a snapshot of the 1st round's burn-in. The table has every 
+candidate's metrics from the last round it was in. "pareto" marks the ones no other candidate is at least as good as
+on all 3 metrics, but the ones dropped early were measured on fewer blocks. */
+struct tune_candidate { string DA; u N, M, blocks; sim_metrics r; double score; bool alive; sim_snapshot warm; };
+
+vector<u> parse_u_list(const string& s) {
+	vector<u> v;
+	stringstream ss(s);
+	for (string x; getline(ss, x, ','); ) { v.push_back(stoull(x)); }
+	return v;
+}
+
+int tune_DAs(const vector<string>& specs, u min_blocks, u max_blocks, double w_SD, double w_delays, double w_stolen) {
+	sim_config base; // main()'s settings and attack
+	vector<tune_candidate> c;
+	for (u k = 0; k < specs.size(); k++) {
+		vector<string> f;
+		stringstream ss(specs[k]);
+		for (string x; getline(ss, x, ':'); ) { f.push_back(x); }
+		string DA = f[0];
+		vector<u> Ns = {17, 30, 45, 60, 90, 120, 144, 200}, Ms = {0};
+		if (DA == "ASERT_" || DA == "ASERT_RTT_" || DA == "ASERT_SMA_" || DA == "ASERTI3_") { Ns = {10}; Ms = {16, 32, 48, 64, 80, 120, 160, 240}; }
+		if (DA == "LWMA_ASERT_") { Ns = {30, 60, 90, 144}; Ms = {16, 32, 80}; }
+		if (DA == "TSA_") { Ns = {30, 60, 100, 144}; Ms = {2, 3, 5, 10}; }
+		if (f.size() > 1) { Ns = parse_u_list(f[1]); }
+		if (f.size() > 2) { Ms = parse_u_list(f[2]); }
+		for (u N : Ns) { for (u M : Ms) { c.push_back(tune_candidate{DA, N, M, 0, sim_metrics(), 0, true, sim_snapshot()}); } }
+	}
+	vector<float> draws(max_blocks);
+	for (u i = 0; i < max_blocks; i++) { draws[i] = log(1/fRand(0.000001,0.999999)); }
+	base.draws = &draws;
+	u threads = std::max(1U, thread::hardware_concurrency());
+	cout << c.size() << " candidates, score = " << w_SD << "*StdDev Diffs% + " << w_delays << "*delays% + " << 
+		w_stolen << "*stolen%, " << threads << " threads." << endl;
+	auto start = chrono::steady_clock::now();
+	for (u blocks = min_blocks; blocks <= max_blocks; blocks *= 2) {
+		// Run every candidate of every DA that has more than 1 left, and in the 1st round all of them.
+		map<string, u> alive;
+		for (auto& x : c) { if (x.alive) { alive[x.DA]++; } }
+		vector<u> run;
+		for (u k = 0; k < c.size(); k++) { 
+			if (c[k].alive && (alive[c[k].DA] > 1 || c[k].blocks == 0)) { run.push_back(k); } 
+		}
+		if (run.empty()) { break; }
+		atomic<u> next(0);
+		auto worker = [&]() {
+			for (u j; (j = next++) < run.size(); ) {
+				tune_candidate& x = c[run[j]];
+				sim_config sc = base;
+				sc.DA = x.DA; sc.N = x.N; sc.M = x.M; sc.blocks = blocks;
+				// Later rounds start from the 1st round's burn-in. Same draws, so same results.
+				x.r = simulation(sc).run(&x.warm);
+				x.blocks = blocks;
+				x.score = w_SD*100*x.r.SD_D + w_delays*x.r.delays + w_stolen*x.r.stolen;
+				if (!(x.score == x.score)) { x.score = 1e300; } // NaN if no attack blocks
+			}
+		};
+		vector<thread> pool;
+		for (u t = 1; t < threads; t++) { pool.push_back(thread(worker)); }
+		worker();
+		for (u t = 0; t < pool.size(); t++) { pool[t].join(); }
+		// Keep the better half (rounded up) of each DA's candidates.
+		for (auto& a : alive) {
+			if (a.second < 2) { continue; }
+			vector<double> scores;
+			for (auto& x : c) { if (x.alive && x.DA == a.first) { scores.push_back(x.score); } }
+			sort(scores.begin(), scores.end());
+			double cut = scores[(scores.size()-1)/2];
+			u kept = 0;
+			for (auto& x : c) { 
+				if (!x.alive || x.DA != a.first) { continue; }
+				x.alive = x.score <= cut && kept < (scores.size()+1)/2;
+				kept += x.alive;
+			}
+		}
+		cout << blocks << " blocks: " << run.size() << " runs, " << 
+			chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+	}
+	sort(c.begin(), c.end(), [](const tune_candidate& a, const tune_candidate& b) { 
+		return a.DA != b.DA ? a.DA < b.DA : a.score < b.score; });
+	cout << "DA		N	M	blocks	score	StdDev Diffs	delays %	stolen %" << endl;
+	for (auto& x : c) {
+		bool pareto = true;
+		for (auto& y : c) {
+			if (y.r.SD_D <= x.r.SD_D && y.r.delays <= x.r.delays && y.r.stolen <= x.r.stolen && 
+				(y.r.SD_D < x.r.SD_D || y.r.delays < x.r.delays || y.r.stolen < x.r.stolen)) { pareto = false; break; }
+		}
+		cout << x.DA << (x.DA.size() < 8 ? "\t\t" : "\t") << x.N << "\t" << x.M << "\t" << x.blocks << "\t" << 
+			round(100*x.score)/100 << "\t" << round(1000*x.r.SD_D)/1000 << "\t\t" << round(100*x.r.delays)/100 << 
+			"\t\t" << round(100*x.r.stolen)/100 << (x.alive ? "\tbest" : "") << (pareto ? "\tpareto" : "") << endl;
+	}
+	return 0;
+}
+
+// ==============================================
+//  =========	SWEEP AND RESULT CACHE  =========
+// ==============================================
+/* sweep runs each DA:N,N,...[:M,M,...] spec at each attack setting with seeds 1 to seeds. Every point is its own
+simulation with draws made from its seed, and the points are spread over all cores. M defaults to N like in replay.
+Results are cached in SWEEP_CACHE_DIR, a file per point named by the 64-bit FNV-1a hash of its sweep_key(): every 
+sim_config setting that changes the result, the seed and DA_CODE_VERSION. The file starts with the key, so a hash 
+collision is a miss and not a wrong result. Change DA_CODE_VERSION when a DA or simulation::run() gives different 
+results, or delete the directory. Runs with given draws, a hashrate profile or a precision_target aren't cached. The
+histogram is of the solvetimes after 2N in T/10 bins up to 6T, and ST_hist and D_hist are log_histograms of all of
+them and of D/avgD. */
+const string DA_CODE_VERSION = "1";
+const string SWEEP_CACHE_DIR = "test_DAs_cache";
+
+struct sweep_result { sim_metrics r; vector<u> histogram; log_histogram ST_hist = log_histogram(1), D_hist = log_histogram(1000); };
+struct sweep_point { sim_config c; string key; sweep_result x; bool cached; };
+
+string sweep_key(const sim_config& c) {
+	if (c.draws || c.profile || c.stop) { return ""; }
+	ostringstream k;
+	k << "DA=" << c.DA << " T=" << c.T << " N=" << c.N << " M=" << c.M << " blocks=" << c.blocks << " baseline_D=" << 
+		c.baseline_D << " difficulty_guess=" << c.difficulty_guess << " baseline_HR=" << c.baseline_HR << " fork_height=" << 
+		c.fork_height << " start_timestamp=" << c.start_timestamp << " start_cd=" << c.start_cd << " dx=" << c.dx << 
+		" cn_delay=" << c.cn_delay << " attack=" << c.attack_start << "," << c.attack_stop << "," << c.attack_size << 
+		" seed=" << c.seed << " version=" << DA_CODE_VERSION;
+	return k.str();
+}
+uint64_t fnv1a_64(const string& s) {
+	uint64_t h = 14695981039346656037ULL;
+	for (unsigned char ch : s) { h ^= ch; h *= 1099511628211ULL; }
+	return h;
+}
+string sweep_cache_path(const string& key) {
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)fnv1a_64(key));
+	return SWEEP_CACHE_DIR + "/" + name + ".txt";
+}
+
+// %.17g so a result read back is the same double, and nan (stolen with no attack blocks) reads back with strtod().
+string sweep_result_line(const sweep_result& x) {
+	const sim_metrics& r = x.r;
+	char line[512];
+	snprintf(line, sizeof(line), "%.17g %.17g %.17g %.17g %.17g %.17g %.17g %.17g %llu %llu", r.avgST, r.avgD, r.SD_D, 
+		r.SD_ST, r.delays, r.stolen, r.TWA_D, r.avgHR, (unsigned long long)r.blocks, (unsigned long long)r.attack_blocks);
+	string s = line;
+	s += " " + to_string(x.histogram.size());
+	for (u y : x.histogram) { s += " " + to_string(y); }
+	return s + " " + x.ST_hist.compact() + " " + x.D_hist.compact();
+}
+bool parse_sweep_result(istream& f, sweep_result& x) {
+	string w[10];
+	for (string& y : w) { f >> y; }
+	u n = 0;
+	f >> n;
+	if (!f) { return false; }
+	sim_metrics& r = x.r;
+	r = sim_metrics();
+	double* d[8] = { &r.avgST, &r.avgD, &r.SD_D, &r.SD_ST, &r.delays, &r.stolen, &r.TWA_D, &r.avgHR };
+	for (int k = 0; k < 8; k++) { *d[k] = strtod(w[k].c_str(), 0); }
+	r.blocks = stoull(w[8]); r.attack_blocks = stoull(w[9]);
+	x.histogram.resize(n);
+	for (u& y : x.histogram) { f >> y; }
+	return x.ST_hist.parse(f) && x.D_hist.parse(f);
+}
+
+bool load_sweep_result(const string& key, sweep_result& x) {
+	ifstream f(sweep_cache_path(key));
+	string magic, k;
+	if (!getline(f, magic) || magic != "DASWEEP2" || !getline(f, k) || k != key) { return false; }
+	return parse_sweep_result(f, x);
+}
+// Written to a temporary file and renamed, so a killed run or another process never sees half a file.
+bool save_sweep_result(const string& key, const sweep_result& x) {
+	mkdir(SWEEP_CACHE_DIR.c_str(), 0755);
+	string path = sweep_cache_path(key);
+	string tmp = path + ".tmp" + to_string(getpid()) + "_" + to_string(hash<thread::id>()(this_thread::get_id()));
+	{
+		ofstream f(tmp);
+		f << "DASWEEP2" << endl << key << endl << sweep_result_line(x) << endl;
+		if (!f) { remove(tmp.c_str()); return false; }
+	}
+	return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// Every point of a sweep in a fixed order: spec, N, M, attack, seed.
+vector<sweep_point> sweep_points(const vector<string>& specs, const vector<vector<u>>& attacks, u blocks, u seeds) {
+	vector<sweep_point> p;
+	for (const string& spec : specs) {
+		vector<string> f;
+		stringstream ss(spec);
+		for (string x; getline(ss, x, ':'); ) { f.push_back(x); }
+		vector<u> Ns = f.size() > 1 ? parse_u_list(f[1]) : vector<u>(1, sim_config().N);
+		for (u N : Ns) {
+			vector<u> Ms = f.size() > 2 ? parse_u_list(f[2]) : vector<u>(1, N);
+			for (u M : Ms) { for (const vector<u>& a : attacks) { for (u seed = 1; seed <= seeds; seed++) {
+				sweep_point x;
+				x.c.DA = f[0]; x.c.N = N; x.c.M = M; x.c.blocks = blocks; x.c.seed = seed;
+				x.c.attack_start = a[0]; x.c.attack_stop = a[1]; x.c.attack_size = a[2];
+				x.key = sweep_key(x.c); x.cached = false;
+				p.push_back(x);
+			} } }
+		}
+	}
+	return p;
+}
+
+// Runs the points that aren't in the cache on all cores. Returns how many were cached.
+u run_sweep_points(vector<sweep_point>& p, bool use_cache) {
+	atomic<u> next(0), hits(0);
+	u threads = std::max(1U, thread::hardware_concurrency());
+	telemetry tel("sweep", threads, p.size(), p.empty() ? 0 : p.size()*p[0].c.blocks);
+	auto worker = [&](u t) {
+		telemetry_worker& progress = tel.attach(t);
+		for (u j; (j = next++) < p.size(); ) {
+			sweep_point& x = p[j];
+			if (use_cache && load_sweep_result(x.key, x.x)) { x.cached = true; hits++; progress.job_skipped(x.c.blocks); continue; }
+			simulation sim(x.c);
+			x.x.r = sim.run();
+			progress.job_done(x.x.r.blocks);
+			x.x.histogram.assign(60, 0);
+			const vector<u>& STs = sim.solvetimes();
+			const vector<u>& Ds = sim.difficulties();
+			x.x.ST_hist = log_histogram(1); x.x.D_hist = log_histogram(1000);
+			for (u i = 2*sim.window()+1; i < x.x.r.blocks; i++) { 
+				if (STs[i] < 6*x.c.T) { x.x.histogram[STs[i]*10/x.c.T]++; } 
+				x.x.ST_hist.record_scaled(STs[i]); x.x.D_hist.record(Ds[i]/x.x.r.avgD);
+			}
+			if (use_cache) { save_sweep_result(x.key, x.x); }
+		}
+	};
+	vector<thread> pool;
+	for (u t = 1; t < threads; t++) { pool.push_back(thread(worker, t)); }
+	worker(0);
+	for (u t = 0; t < pool.size(); t++) { pool[t].join(); }
+	return hits;
+}
+
+void print_sweep_row(const sim_config& c, const sim_metrics& r) {
+	cout << c.DA << (c.DA.size() < 8 ? "\t\t" : "\t") << c.N << "\t" << c.M << "\t" << c.attack_start << "," << 
+		c.attack_stop << "," << c.attack_size << "\t" << c.seed << "\t" << r.avgST << "\t" << round(1000*r.SD_D)/1000 << 
+		"\t\t" << round(100*r.SD_ST)/100 << "\t\t" << round(100*r.delays)/100 << "\t" << round(100*r.stolen)/100 << 
+		"\t" << r.TWA_D << endl;
+}
+const char* SWEEP_HEADER = "DA\t\tN\tM\tattack\t\tseed\tavg ST\tStdDev Diffs\tStdDev STs\tdelays%\tstolen%\tTWA D";
+
+/* Sharding: with --shard i/n a sweep only runs the points whose index (in sweep_points() order) is i mod n, and
+writes them to a shard file with the sweep's arguments, so any number of processes or machines can each run a shard
+with nothing shared but a directory. sweep_merge reads the shard files, checks they are from the same sweep and that 
+every point is there exactly once with the key the arguments give it, and writes all of them as one file (a shard
+0/1 that it can merge again) and prints the table. A shard file is:
+	DASHARD2
+	args <blocks seeds specs and attacks>
+	shard i n points
+	point <index> <sweep_key()>
+	<sweep_result_line()>
+	... */
+struct sweep_args {
+	u blocks = 0, seeds = 0, shard = 0, shards = 1;
+	vector<string> specs;
+	vector<vector<u>> attacks;
+	bool use_cache = true;
+	string out;	 // shard file
+	string canonical;  // the arguments that choose the points
+};
+
+bool parse_sweep_args(const vector<string>& args, sweep_args& a) {
+	if (args.size() < 3) { return false; }
+	a.blocks = stoull(args[0]); a.seeds = stoull(args[1]);
+	a.canonical = args[0] + " " + args[1];
+	for (u k = 2; k < args.size(); k++) {
+		const string& x = args[k];
+		if (x == "nocache") { a.use_cache = false; continue; }
+		if (x == "--out" && k+1 < args.size()) { a.out = args[++k]; continue; }
+		if (x == "--shard" && k+1 < args.size()) {
+			if (sscanf(args[++k].c_str(), "%llu/%llu", (unsigned long long*)&a.shard, (unsigned long long*)&a.shards) != 2 ||
+				a.shards == 0 || a.shard >= a.shards) { cout << "--shard needs i/n with i < n" << endl; return false; }
+			continue;
+		}
+		if (x.compare(0, 7, "attack:") == 0) { 
+			a.attacks.push_back(parse_u_list(x.substr(7))); 
+			if (a.attacks.back().size() != 3) { cout << x << " needs start,stop,size" << endl; return false; }
+		}
+		else { a.specs.push_back(x); }
+		a.canonical += " " + x;
+	}
+	if (a.attacks.empty()) { sim_config c; a.attacks.push_back({c.attack_start, c.attack_stop, c.attack_size}); }
+	if (a.out.empty() && a.shards > 1) { a.out = "sweep_shard_" + to_string(a.shard) + "_of_" + to_string(a.shards) + ".txt"; }
+	return !a.specs.empty();
+}
+
+bool write_sweep_shard(const string& path, const string& canonical, u shard, u shards, u points, 
+					const vector<u>& index, const vector<sweep_point>& p) {
+	string tmp = path + ".tmp" + to_string(getpid());
+	{
+		ofstream f(tmp);
+		f << "DASHARD2" << endl << "args " << canonical << endl << "shard " << shard << " " << shards << " " << points << endl;
+		for (u k = 0; k < index.size(); k++) {
+			f << "point " << index[k] << " " << p[k].key << endl << sweep_result_line(p[k].x) << endl;
+		}
+		if (!f) { remove(tmp.c_str()); return false; }
+	}
+	return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+int sweep(const sweep_args& a) {
+	vector<sweep_point> all = sweep_points(a.specs, a.attacks, a.blocks, a.seeds), p;
+	vector<u> index;
+	for (u j = a.shard; j < all.size(); j += a.shards) { index.push_back(j); p.push_back(all[j]); }
+	auto start = chrono::steady_clock::now();
+	u hits = run_sweep_points(p, a.use_cache);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	cout << SWEEP_HEADER << endl;
+	for (const sweep_point& x : p) { print_sweep_row(x.c, x.x.r); }
+	cout << p.size() << " points" << (a.shards > 1 ? " (shard " + to_string(a.shard) + "/" + to_string(a.shards) + 
+		" of " + to_string(all.size()) + ")" : "") << ", " << hits << " from the cache (" << 
+		(p.empty() ? 0 : 100*hits/p.size()) << "% hit rate), " << p.size()-hits << " run in " << seconds << " s" << endl;
+	if (!a.out.empty()) {
+		if (!write_sweep_shard(a.out, a.canonical, a.shard, a.shards, all.size(), index, p)) { 
+			cout << "Can't write " << a.out << endl; return 1; 
+		}
+		cout << "Wrote " << a.out << endl;
+	}
+	return 0;
+}
+
+int sweep_merge(const string& out, const vector<string>& files) {
+	string canonical;
+	u shards = 0, points = 0, errors = 0;
+	vector<sweep_point> p;
+	vector<u> seen;
+	for (const string& path : files) {
+		ifstream f(path);
+		string magic, line, word;
+		u shard, n, total;
+		getline(f, magic);
+		getline(f, line);
+		f >> word >> shard >> n >> total;
+		if (!f || magic != "DASHARD2" || line.compare(0, 5, "args ") != 0 || word != "shard") { 
+			cout << path << " is not a shard file." << endl; return 1; 
+		}
+		if (canonical.empty()) {
+			canonical = line.substr(5); shards = n; points = total;
+			sweep_args a;
+			stringstream ss(canonical);
+			vector<string> args;
+			for (string x; ss >> x; ) { args.push_back(x); }
+			if (!parse_sweep_args(args, a)) { cout << path << " has bad sweep arguments." << endl; return 1; }
+			p = sweep_points(a.specs, a.attacks, a.blocks, a.seeds);
+			if (p.size() != points) { cout << path << " says " << points << " points but its arguments make " << p.size() << endl; return 1; }
+			seen.assign(points, 0);
+		}
+		else if (line.substr(5) != canonical || n != shards || total != points) {
+			cout << path << " is from another sweep or sharding." << endl; return 1;
+		}
+		u j;
+		for (string key; f >> word >> j && getline(f, key); ) {
+			key = key.substr(1);
+			sweep_result x;
+			if (word != "point" || !parse_sweep_result(f, x)) { cout << path << " is truncated." << endl; return 1; }
+			if (j >= points || key != p[j].key) { cout << path << ": point " << j << " isn't the sweep's." << endl; errors++; continue; }
+			if (seen[j]++) { cout << path << ": point " << j << " is a duplicate." << endl; errors++; continue; }
+			p[j].x = x;
+		}
+	}
+	u missing = 0;
+	for (u j = 0; j < points; j++) { 
+		if (seen[j]) { continue; }
+		if (missing++ < 10) { cout << "Point " << j << " (shard " << j % shards << ") is missing: " << p[j].key << endl; }
+	}
+	if (missing || errors) { cout << missing << " points missing, " << errors << " bad. Nothing written." << endl; return 1; }
+	cout << SWEEP_HEADER << endl;
+	for (const sweep_point& x : p) { print_sweep_row(x.c, x.x.r); }
+	vector<u> index(points);
+	for (u j = 0; j < points; j++) { index[j] = j; }
+	if (!write_sweep_shard(out, canonical, 0, 1, points, index, p)) { cout << "Can't write " << out << endl; return 1; }
+	cout << "Merged " << files.size() << " shards, " << points << " points into " << out << endl;
+	return 0;
+}
+
+// ==============================================
+//  =========	REPLICAS  =======================
+// ==============================================
+/* Many chains of an O(1) state DA run side by side. A chain is an o1_state and an attack flag, 25 bytes, so millions
+fit where a window DA's N+1 timestamps and cumulative difficulties per chain would not. The chains are split over 
+all cores and every thread moves its chains up 1 height at a time. Each chain has main()'s on-off attack (attack_size
+100 for none) and its own draws. Metrics are over all chains' blocks after 2N like run_simulation()'s, but delays is
+only the ST > 4*T part and StdDev Diffs is of all those blocks together. "across chains" is the StdDev of the last 
+block's D between chains. */
+int run_replicas(const string& DA, u T, u N, u M, u count, u blocks, u attack_start, u attack_stop, u attack_size) {
+	int o1 = o1_DA(DA);
+	if (!o1) { cout << DA << " is not an O(1) state DA: EMA_ EMA3_ ASERT_ ETH_" << endl; return 1; }
+	BASELINE_D = 1e4; START_TIMESTAMP = 1540000000; DX = 1;
+	u baseline_HR = BASELINE_D*DX/T;
+	o1_state genesis = { BASELINE_D, START_TIMESTAMP - T, START_TIMESTAMP };
+	vector<o1_state> chains(count, genesis);
+	vector<unsigned char> attack_on(count, 0);
+	struct sums { double ST, D, D2, delays, d_time, d_reward, a_time, a_reward, last_D, last_D2; };
+	u threads = std::max(1u, thread::hardware_concurrency());
+	vector<sums> part(threads, sums());
+	vector<log_histogram> ST_part(threads, log_histogram(1)), D_part(threads, log_histogram(1000));
+	vector<u> seeds(threads);
+	for (u& x : seeds) { x = rand(); }
+	auto start = chrono::steady_clock::now();
+	telemetry tel("replicas " + DA, threads, threads, count*blocks);
+	vector<thread> pool;
+	for (u t = 0; t < threads; t++) {
+		pool.emplace_back([&, t]() {
+			telemetry_worker& progress = tel.attach(t);
+			mt19937_64 rng(seeds[t]);
+			uniform_real_distribution<double> U(0.000001, 0.999999);
+			sums s = sums(); // not part[t] while running, they share cache lines
+			log_histogram ST_hist(1), D_hist(1000);
+			double D_scale = 1000.0/BASELINE_D;
+			for (u h = 0; h < blocks; h++) {
+				for (u k = t*count/threads; k < (t+1)*count/threads; k++) {
+					o1_state& c = chains[k];
+					if (c.D > (attack_stop*BASELINE_D)/100) { attack_on[k] = 0; }
+					else if (c.D < (attack_start*BASELINE_D)/100) { attack_on[k] = 1; }
+					u HR = std::max(u(1), baseline_HR*(attack_on[k] ? attack_size : 100)/100);
+					u D = h <= N+1 ? BASELINE_D : c.next_D(o1, T, N, M);
+					u ST = simulate_ST(D, DX, HR, log(1/U(rng)));
+					c.add_block(o1, D, c.timestamp + ST);
+					if (h <= 2*N) { continue; }
+					double nST = double(ST)/T, reward = nST*BASELINE_D/D;
+					s.ST += ST; s.D += D; s.D2 += double(D)*D;
+					if (nST > 4) { s.delays += nST - 4; }
+					s.d_time += nST; s.d_reward += reward;
+					if (attack_on[k] && attack_size > 100) { s.a_time += nST; s.a_reward += reward; }
+					if (h == blocks-1) { s.last_D += D; s.last_D2 += double(D)*D; }
+					ST_hist.record_scaled(ST); D_hist.record_scaled(u(D*D_scale));
+				}
+				progress.current.store((h+1)*((t+1)*count/threads - t*count/threads), memory_order_relaxed);
+			}
+			progress.job_done(blocks*((t+1)*count/threads - t*count/threads));
+			part[t] = s; ST_part[t] = ST_hist; D_part[t] = D_hist;
+		});
+	}
+	for (auto& x : pool) { x.join(); }
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	sums s = sums();
+	for (const sums& x : part) {
+		s.ST += x.ST; s.D += x.D; s.D2 += x.D2; s.delays += x.delays; s.d_time += x.d_time; s.d_reward += x.d_reward;
+		s.a_time += x.a_time; s.a_reward += x.a_reward; s.last_D += x.last_D; s.last_D2 += x.last_D2;
+	}
+	log_histogram ST_hist(1), D_hist(1000);
+	for (u t = 0; t < threads; t++) { ST_hist.merge(ST_part[t]); D_hist.merge(D_part[t]); }
+	double n = double(count)*(blocks > 2*N+1 ? blocks-2*N-1 : 0), avgD = s.D/n, last_D = s.last_D/count;
+	cout << count << " " << DA << " chains, N=" << N << (o1 == O1_ASERT ? " M=" + to_string(M) : "") << ", " << blocks << 
+		" blocks, " << count*(sizeof(o1_state)+1)/1e6 << " MB of chain state, " << seconds << " s (" << 
+		1e9*seconds*threads/count/blocks << " ns per block per core)" << endl;
+	cout << "avg ST/T: " << s.ST/n/T << " StdDev Diffs: " << sqrt(std::max(0.0, s.D2/n/avgD/avgD - 1)) << 
+		" delays %: " << 100*s.delays/n << " stolen %: " << 
+		(s.a_time > 0 ? 100*((s.a_reward/s.a_time)/(s.d_reward/s.d_time) - 1) : 0) << 
+		" last D across chains: " << last_D << " +/- " << sqrt(std::max(0.0, s.last_D2/count - last_D*last_D)) << endl;
+	cout << "Solvetime p50/p99/p99.99: " << ST_hist.percentiles() << " s. D/baseline p50/p99/p99.99: " << 
+		D_hist.percentiles() << endl;
+	return 0;
+}
+
+int main(int argc, char* argv[]) 
 {
+// These modes take inputs. Otherwise everything is set below.
+//   ./test_DAs make_headers headers.txt headers.bin [nBits]
+//   ./test_DAs replay headers.bin T N [M] [DX]    (M defaults to N, DX to 1, or 2^32 for nBits)
+//   ./test_DAs replay_multi headers.bin T N,N,... [M,M,...] [DA,DA,...] [check]    many N in one pass
+//   ./test_DAs verify headers.bin DA T N [M] [threads]    prints the first height with a wrong difficulty
+//   ./test_DAs verify_benchmark [headers] [threads]
+//   ./test_DAs service DA T N [M] [unix_socket_path]    next difficulty service, stdin if no socket
+//   ./test_DAs schedule_benchmark [points] [step]    difficulty vs template timestamp for RTT DAs
+//   ./test_DAs asert_check [draws]    ASERTI3_'s error and time per block vs ASERT_ and ASERT_SMA_
+//   ./test_DAs o1_check T N blocks [M]    the O(1) state DAs vs their window versions with out-of-sequence timestamps
+//   ./test_DAs rtt_sampler_check [draws]    RTT solvetimes from the tabulated hazard vs the closed forms
+//   ./test_DAs miners DA T N miners blocks [switching HR multiple] [M]    event-driven many-miner simulation
+//   ./test_DAs coins blocks miners mobile_HR_multiple DA:T:N[:M] DA:T:N[:M] ...    coins sharing mobile hashrate
+//   ./test_DAs compare replications blocks [antithetic] [control] DA:N[:M] DA:N[:M] ...    paired differences with CIs
+//   ./test_DAs converge max_blocks avgST_% stolen delays DA:N[:M] ...    run each DA until its 95% CIs are that narrow
+//   ./test_DAs rare DA T N k above|below threshold [samples] [lambda] [M]    importance sampling of rare solvetime sums
+//   ./test_DAs snapshot DA T N [file] [M]    save the state after a 2N block burn-in at constant hashrate
+//   ./test_DAs warm file blocks [attack_start attack_stop attack_size]    run that many blocks from a snapshot
+//   ./test_DAs checkpoint DA T N blocks seed file [every] [M] [--resume]    long run that saves its progress to file
+//   ./test_DAs replicas DA T N chains blocks [attack_start attack_stop attack_size] [M]    many O(1) state chains at once
+//   ./test_DAs sweep blocks seeds DA[:N,N,...[:M,M,...]] ... [attack:start,stop,size ...] [nocache] [--shard i/n] [--out file]
+//   ./test_DAs sweep_merge merged.txt shard_files...    check that every point is there once and combine them
+//   ./test_DAs tune min_blocks max_blocks w_SD w_delays w_stolen DA[:N,N,...[:M,M,...]] ...    search N and M per DA
+// sweep, checkpoint and replicas print their progress to cerr every 10 s. Anywhere in the arguments, --progress seconds
+// changes that (0 for none) and --status file.json keeps a JSON status in file.json. They're taken out here.
+for (int a = 1; a+1 < argc; ) {
+	string x = argv[a];
+	if (x != "--progress" && x != "--status") { a++; continue; }
+	if (x == "--progress") { PROGRESS_SECONDS = stod(argv[a+1]); }
+	else { STATUS_FILE = argv[a+1]; }
+	for (int b = a; b+2 <= argc; b++) { argv[b] = argv[b+2]; }
+	argc -= 2;
+}
+DX = 1;
+if (argc >= 4 && string(argv[1]) == "make_headers") {
+	u count = make_header_file(argv[2], argv[3], argc > 4 && string(argv[4]) == "nBits");
+	cout << count << " headers written to " << argv[3] << endl;
+	return 0;
+}
+if (argc >= 5 && string(argv[1]) == "replay") {
+	u T = stoull(argv[3]), N = stoull(argv[4]);
+	u M = argc > 5 ? stoull(argv[5]) : N;
+	replay(argv[2], T, N, M, argc > 6 ? stoull(argv[6]) : 0);
+	return 0;
+}
+if (argc >= 5 && string(argv[1]) == "replay_multi") {
+	vector<u> Ns = parse_u_list(argv[4]), Ms = Ns;
+	vector<string> DAs = { "SMA_", "LWMA1_", "DIGISHIELD_", "DIGISHIELD_improved_", "ASERT_", "ASERT_SMA_", "ASERTI3_" };
+	bool check = false;
+	for (int a = 5; a < argc; a++) {
+		string x = argv[a];
+		if (x == "check") { check = true; }
+		else if (isdigit(x[0])) { Ms = parse_u_list(x); }
+		else { DAs.clear(); stringstream ss(x); for (string y; getline(ss, y, ','); ) { DAs.push_back(y); } }
+	}
+	return replay_multi(argv[2], stoull(argv[3]), Ns, Ms, DAs, check);
+}
+if (argc >= 6 && string(argv[1]) == "verify") {
+	header_file hf;
+	if (!open_header_file(argv[2], hf)) { return 1; }
+	u N = stoull(argv[5]);
+	int64_t bad = verify_headers(argv[3], hf.headers, hf.count, hf.uses_nBits, hf.dx, stoull(argv[4]), N, 
+		argc > 6 ? stoull(argv[6]) : N, argc > 7 ? stoull(argv[7]) : 0);
+	close_header_file(hf);
+	if (bad < 0) { cout << "All " << hf.count << " headers are valid." << endl; }
+	else { cout << "First invalid height: " << bad << endl; }
+	return bad >= 0;
+}
+if (argc >= 5 && string(argv[1]) == "service") {
+	u N = stoull(argv[4]);
+	if (find(WINDOW_DAS.begin(), WINDOW_DAS.end(), string(argv[2])) == WINDOW_DAS.end()) { 
+		cout << argv[2] << " is not a window DA." << endl; return 1; 
+	}
+	DA_service service(argv[2], stoull(argv[3]), N, argc > 5 ? stoull(argv[5]) : N);
+	if (argc > 6) { return serve_unix_socket(service, argv[6]); }
+	serve_stream(service, cin, cout);
+	return 0;
+}
+if (argc >= 5 && string(argv[1]) == "snapshot") {
+	// Burn-in at constant hashrate, saved for warm runs.
+	srand(time(0));
+	BASELINE_D = 1e4; FORK_HEIGHT = 0; START_TIMESTAMP = 1540000000; START_CD = 1E9; DX = 1; USE_CN_DELAY = 0;
+	ENABLE_FILE_WRITES = 0; PRINT_BLOCKS_TO_COMMAND_LINE = 0; QUIET = 1;
+	u T = stoull(argv[3]), N = stoull(argv[4]), M = argc > 6 ? stoull(argv[6]) : 0;
+	BLOCKS = 2*N+20; // + DIGISHIELD_'s 6
+	for (u i = 0; i < BLOCKS; i++) { NEG_LOG_RAND.push_back(log(1/fRand(0.000001,0.999999))); }
+	sim_snapshot s;
+	run_simulation(argv[2], T, N, BASELINE_D, (BASELINE_D*DX)/T, 130, 135, 100, M, 0, 0, &s);
+	string path = argc > 5 ? argv[5] : string("snapshot_") + argv[2] + ".txt";
+	if (!save_snapshot(s, path)) { cout << "Can't write " << path << endl; return 1; }
+	cout << "Saved " << argv[2] << " " << N << " after " << s.start << " blocks to " << path << endl;
+	return 0;
+}
+if (argc >= 4 && string(argv[1]) == "warm") {
+	srand(time(0));
+	sim_snapshot s;
+	if (!load_snapshot(s, argv[2])) { return 1; }
+	BASELINE_D = s.baseline_D; FORK_HEIGHT = s.fork_height; START_TIMESTAMP = s.start_timestamp; START_CD = s.start_cd; 
+	DX = s.dx; USE_CN_DELAY = s.cn_delay; ENABLE_FILE_WRITES = 0; PRINT_BLOCKS_TO_COMMAND_LINE = 0;
+	BLOCKS = s.start + stoull(argv[3]);
+	for (u i = 0; i < BLOCKS; i++) { NEG_LOG_RAND.push_back(log(1/fRand(0.000001,0.999999))); }
+	HR_PROFILE = make_hashrate_profile("constant", 4*BLOCKS*s.T);
+	u N = s.DA == "DIGISHIELD_" ? s.N-6 : s.N; // run_simulation() adds it back
+	run_simulation(s.DA, s.T, N, BASELINE_D, (BASELINE_D*DX)/s.T, argc > 4 ? stoull(argv[4]) : 130, 
+		argc > 5 ? stoull(argv[5]) : 135, argc > 6 ? stoull(argv[6]) : 800, s.M, 0, 0, &s);
+	return 0;
+}
+if (argc >= 8 && string(argv[1]) == "checkpoint") {
+	bool resume = string(argv[argc-1]) == "--resume";
+	int args = resume ? argc-1 : argc;
+	sim_config c;
+	c.DA = argv[2]; c.T = stoull(argv[3]); c.N = stoull(argv[4]); c.blocks = stoull(argv[5]); c.seed = stoull(argv[6]);
+	c.M = args > 9 ? stoull(argv[9]) : c.N;
+	sim_checkpoint ck;
+	ck.path = argv[7]; ck.key = sweep_key(c); ck.resume = resume;
+	if (args > 8) { ck.every = std::max(1ULL, stoull(argv[8])); }
+	simulation sim(c);
+	auto start = chrono::steady_clock::now();
+	telemetry tel("checkpoint " + c.DA, 1, 1, c.blocks);
+	telemetry_worker& progress = tel.attach(0);
+	const sim_metrics& r = sim.run(0, &ck);
+	progress.job_done(r.blocks);
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << SWEEP_HEADER << endl;
+	print_sweep_row(c, r);
+	if (ck.resumed_at) { cout << "Resumed at block " << ck.resumed_at << ". "; }
+	cout << ck.written << " checkpoints in " << ms/1000 << " s. The run waited " << ck.wait_ms << " ms for them (" << 
+		100*ck.wait_ms/ms << "%) and the thread writing them took " << ck.write_ms << " ms." << endl;
+	return 0;
+}
+if (argc >= 8 && string(argv[1]) == "tune") {
+	srand(time(0));
+	return tune_DAs(vector<string>(argv+7, argv+argc), stoull(argv[2]), stoull(argv[3]), stod(argv[4]), stod(argv[5]), 
+		stod(argv[6]));
+}
+if (argc >= 5 && string(argv[1]) == "sweep") {
+	sweep_args a;
+	if (!parse_sweep_args(vector<string>(argv+2, argv+argc), a)) { return 1; }
+	return sweep(a);
+}
+if (argc >= 4 && string(argv[1]) == "sweep_merge") {
+	return sweep_merge(argv[2], vector<string>(argv+3, argv+argc));
+}
+if (argc >= 7 && string(argv[1]) == "replicas") {
+	srand(time(0));
+	u N = stoull(argv[4]);
+	return run_replicas(argv[2], stoull(argv[3]), N, argc > 10 ? stoull(argv[10]) : N, stoull(argv[5]), stoull(argv[6]),
+		argc > 7 ? stoull(argv[7]) : 130, argc > 8 ? stoull(argv[8]) : 135, argc > 9 ? stoull(argv[9]) : 800);
+}
+if (argc >= 8 && string(argv[1]) == "rare") {
+	srand(time(0));
+	u N = stoull(argv[4]);
+	return rare_event(argv[2], stoull(argv[3]), N, argc > 10 ? stoull(argv[10]) : N, stoull(argv[5]), 
+		string(argv[6]) == "above", stod(argv[7]), argc > 8 ? stoull(argv[8]) : 100000, argc > 9 ? stod(argv[9]) : 0);
+}
+if (argc >= 7 && string(argv[1]) == "converge") {
+	srand(time(0));
+	precision_target target = { stod(argv[3]), stod(argv[4]), stod(argv[5]), 2000, 10 };
+	return converge_DAs(vector<string>(argv+6, argv+argc), stoull(argv[2]), target);
+}
+if (argc >= 5 && string(argv[1]) == "compare") {
+	srand(time(0));
+	vector<string> specs;
+	bool antithetic = false, control = false;
+	for (int a = 4; a < argc; a++) {
+		if (string(argv[a]) == "antithetic") { antithetic = true; }
+		else if (string(argv[a]) == "control") { control = true; }
+		else { specs.push_back(argv[a]); }
+	}
+	return compare_DAs(specs, stoull(argv[2]), stoull(argv[3]), antithetic, control);
+}
+if (argc >= 6 && string(argv[1]) == "coins") {
+	srand(time(0));
+	BASELINE_D = 1e4; START_TIMESTAMP = 1540000000; 
+	return run_coins(vector<string>(argv+5, argv+argc), stoull(argv[2]), stoull(argv[3]), stod(argv[4]));
+}
+if (argc >= 7 && string(argv[1]) == "miners") {
+	srand(time(0));
+	BASELINE_D = 1e4; START_TIMESTAMP = 1540000000; 
+	u N = stoull(argv[4]);
+	return run_miners(argv[2], stoull(argv[3]), N, argc > 8 ? stoull(argv[8]) : N, stoull(argv[5]), stoull(argv[6]), 
+		argc > 7 ? stod(argv[7]) : 2);
+}
+if (argc >= 2 && string(argv[1]) == "asert_check") {
+	srand(time(0));
+	return asert_check(argc > 2 ? stoull(argv[2]) : 1000000);
+}
+if (argc >= 5 && string(argv[1]) == "o1_check") {
+	srand(time(0));
+	u N = stoull(argv[3]);
+	return o1_check(stoull(argv[2]), N, argc > 5 ? stoull(argv[5]) : N, stoull(argv[4]));
+}
+if (argc >= 2 && string(argv[1]) == "rtt_sampler_check") {
+	return rtt_sampler_check(argc > 2 ? stoull(argv[2]) : 1000000);
+}
+if (argc >= 2 && string(argv[1]) == "schedule_benchmark") {
+	return schedule_benchmark(argc > 2 ? stoull(argv[2]) : 3600, argc > 3 ? stoull(argv[3]) : 1);
+}
+if (argc >= 2 && string(argv[1]) == "verify_benchmark") {
+	srand(time(0));
+	verify_benchmark(argc > 2 ? stoull(argv[2]) : 1000000, argc > 3 ? stoull(argv[3]) : 0);
+	return 0;
+}
+
 u N; string DA; srand(time(0)); // seed for fRand();
 u M = 0; // extra parameter for some algos
 
@@ -819,6 +3725,9 @@ USE_CN_DELAY = 0; // 1 = yes, 0=no. CN coins have a delay on timestamps
 
 BLOCKS = 20000; //################################## BLOCKS to simulate
 
+// Hashrate profile, see make_hashrate_profile(). e.g. "diurnal:0.3", "step:2000000:2", "file:hashrate.txt"
+HR_PROFILE = make_hashrate_profile("constant", 4*BLOCKS*T);
+
 // Get -ln(x) values for all algos #####
 for (int i=0; i <= BLOCKS-1; i++) { NEG_LOG_RAND.push_back(log( 1/fRand(0.000001,0.999999))); }
 // Do not plot if run is > 30,000
@@ -865,6 +3774,12 @@ run_simulation(DA, T, N, difficulty_guess, baseline_HR, attack_start,attack_stop
 
 
 /*
+// DIGISHIELD_improved_ with the difficulty_jump.h adjustments on top. Off until it stops running away: after a trigger 
+// the long solvetime pulls the baseline down but its high D hardly moves DIGISHIELD's harmonic mean.
+DA = "RT_CST_RST_";
+N = 17; IDENTIFIER++;
+run_simulation(DA, T, N, difficulty_guess, baseline_HR, attack_start,attack_stop,attack_size, 0); 
+
 DA = "DIGISHIELD_improved_"; 
 N = 15; IDENTIFIER++;
 run_simulation(DA, T, N, difficulty_guess, baseline_HR, attack_start,attack_stop,attack_size, 0);
@@ -911,16 +3826,16 @@ DA="TSA";
 
 // Unlike others, attack_start is relative to avg of N difficulties and is based on 
 // TSA_D for a given timestamp
-R = 1;  // only 1, 2, and 4 supported in simulation. This is only needed for TSA.
+R = 1;  // M for TSA_. Any value works in simulation, see rtt_shape_for().
 N = 600; IDENTIFIER++;
 run_simulation(DA, T, N, difficulty_guess, baseline_HR, attack_start,attack_stop,attack_size,R);
 
-R = 2;  // only 2 and 4 supported in simulation. This is only needed for TSA.
+R = 2;  // M for TSA_
 CONSTANT_HR =0;
 N = 600; IDENTIFIER++;
 run_simulation(DA, T, N, difficulty_guess, baseline_HR, attack_start,attack_stop,attack_size,R);
 
-R = 4;  // only 2 and 4 supported in simulation. This is only needed for TSA.
+R = 4;  // M for TSA_
 CONSTANT_HR =0;
 N = 600; IDENTIFIER++;
 run_simulation(DA, T, N, difficulty_guess, baseline_HR, attack_start,attack_stop,attack_size,R);
@@ -1,272 +1,401 @@
-// Timespan Limit Attack Demonstration
-// Copyright (c) Zawy 2019
-// MIT License
-/*
-This demonstrates how a >50% selfish mining attack can get unlimited number of blocks in about 3x the 
-difficulty window by retarding the MTP and using timespan limits against themselves. The attack can work on 
-any algo that use a timespan limit without requiring the timestamps to be sequential. It currently only
-tests symmetrical limits on simple moving averages like BCH and DASH. A future update may include the 
-easier cases of fixed-window algos like BTC and LTC and asymmetrical fractional limits.
-See https://github.com/zawy12/difficulty-algorithms/issues/30
-*/
-
-#include <iostream>     // for cout
-#include <math.h>		
-#include <string>
-#include <cstdint>
-#include <bits/stdc++.h> // for array sort
-using namespace std;
-typedef int64_t u;
-typedef double d; // instead of arith_256
-
-float fRand(float fMin, float fMax) {   
-		float f = (float)rand() / RAND_MAX;
-    return fMin + f * (fMax - fMin);
-}
-u median(u a[], u n) { sort(a, a+n);   return a[n/2];  } 
-
-d BCH(d targets[], u S[], u N, u T, u L, u h) {
-	d sumTargets=0;
-	u front_array[3] = {S[h-1],   S[h-2],   S[h-3]};
-	u back_array[3]  = {S[h-1-N], S[h-2-N], S[h-3-N]};
-	// BCH reduces out of sequence timstamps like this:
-	u front = median( front_array, 3 );
-	u back = median( back_array, 3 );
-	// Here's the limit that allows the exploit.
-	u timespan = min(L*N*T, max(N*T/L, front - back));
-	
-	// Identify the corresponding targets
-	u j;
-	if	(front == S[h-1])	{ j = h-1; }
-	else if (front == S[h-2])	{ j = h-2; }
-	else				{ j = h-3; }
-	u k;
-	if	(back == S[h-1-N])	{ k = h-1-N; }
-	else if (back == S[h-2-N])	{ k = h-2-N; }
-	else				{ k = h-3-N; }
-	for (u i = j; i > k; i-- ) { sumTargets += targets[i]; }
-	return sumTargets*timespan/T/(j-k)/(j-k); 
-}
-d SMA(d targets[], u S[], u N, u T, u L, u h) {
-	d sumTargets=0;
-	u timespan = min(L*N*T, max(N*T/L, S[h-1] - S[h-1-N]));
-	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
-	return sumTargets*timespan/T/N/N; 
-}
-d Digishield(d targets[], u S[], u N, u T, u L, u h) {
-	// This does not include the MTP delay in Digishield that stops the attack.
-	d sumTargets=0;
-	u timespan = min(L*N*T, max(N*T/L, S[h-1] - S[h-1-N]));
-	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
-	return sumTargets*(3*N*T + timespan)/T/N/N; 
-}
-d DGW(d targets[], u S[], u N, u T, u L, u h) {
-	d sumTargets=0;
-	u timespan = min(L*N*T, max(N*T/L, S[h-1] - S[h-1-N]));
-	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
- // The following makes DGW different from SMA: double weight to most recent target.
-	sumTargets +=targets[h-1];
-	return sumTargets*timespan/T/N/(N+1);  
-}
-d LWMA(d targets[], u S[], u N, u T, u L, u h) {
-	// not currently supported because the attack needs to be modified
-	d sumTargets=0;
-	u weighted_sum_time;
-	for (u i = h-1; i>=h-N; i--) { weighted_sum_time += min(6*T,max(-6*T,(S[i]-S[i-1]))); }
-	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
-	return sumTargets*weighted_sum_time*2/T/N/N/(N+1); 
-}
-d run_DA (string choose_DA, d targets[], u S[], u N, u T, u L, u h) {
-	if (choose_DA == "BCH") { BCH(targets, S, N, T, L, h); }
-	if (choose_DA == "SMA" ) { SMA(targets, S, N, T, L, h); }
-	if (choose_DA == "DGW" ) { DGW(targets, S, N, T, L, h); }
-/*	if (choose_DA == "Digishield" ) { Digishield(targets, S, N, T, L, h); }
-	if (choose_DA == "LWMA" ) { LWMA(targets, S, N, T, L, h); }
-	if (choose_DA == "Boris" ) { Boris(targets, S, N, T, L, h); }
-	if (choose_DA == "BTC" ) { BTC(targets, S, N, T, L, h); }
-	if (choose_DA == "LTC" ) { LTC(targets, S, N, T, L, h); }
-	if (choose_DA == "ETH" ) { ETH(targets, S, N, T, L, h); }   */
-}
-int main () {
-srand(time(0));
-
-u test_DA = 0; // set to 1 to test DA code without the attack
-
-u N = 20; // difficulty averaging window, use > MTP
-u L = 2; // timespan limit. BTC=4, BCH=2, DASH / DGW=3. Symmetrical assumed.
-u T = 100; // block time
-u MTP = 11; // most coins use MTP=11 (median of the past 11 timestamps)
-
-// The following is adjusted to increase the # of blocks gained and decrease the time required.
-// Select a target number of blocks (via blocks = 10*N below) then keep adjusting it.
-
-u adjust = 115;  // This is critical. A change of 1% can double the blocks. Typical range: 25 to 150.
-u try_all_adjusts = 0; // Set to 1 if you want it to try adjust settings 24 to 150.
-
-string choose_DA = "BCH"; // currently supports BCH, SMA, or DGW
-
-if (choose_DA == "BCH" ) { T=600; N=144; L=2; }  // BCH adjust = 103 got 70k blocks in 3.5 days; 
-if (choose_DA == "DGW" ) { N=24; L=3; }   // DGW.  Adjust = 25 got a lot
-
-u blocks = 1000; // How many blocks to get. (try = 3*N at first)
-
-u S[blocks + N + MTP]; // S = stamps = timestamps
-u real_time[blocks + N + MTP];
-// Using doubles to avoid arith_256 header.
-d solvetime = 0; // for keeping track of real time
-d targets[blocks + N + MTP];
-d public_HR = 100000; // Hashes per second
-d attacker_HR = 1; // attacker's HR as fraction of public_HR without him (1=50% attack, 2 = 66%) 
-d leading_zeros = 32; // 32 for BTC
-d powLimit = pow(2,256-leading_zeros);
-d difficulty; 
-d avg_initial_diff = public_HR*T/pow(2,leading_zeros);
-assert( MTP % 2 == 1); // allow only odd for easily finding median
-
-// h = height, S[] = timestamps
-
-cout << "Initialize N + MTP blocks:\nheight,\ttimestamps,\tdifficulty,\ttarget,\treal time,\tsolvetime\n"; 
-
-// Initialize N+1 targets and timestamps before attack begins. 
-S[0]=0; // typically 0 or time(0)
-real_time[0] = S[0]; 
-targets[0]=pow(2,256)/public_HR/T;
-u do_things_proper_which_makes_results_harder_to_understand = 0;
-for (u h=1; h<N+MTP; h++) { 
-	if (do_things_proper_which_makes_results_harder_to_understand) {
-		solvetime = u(round(T*log( 1/fRand(0,1))));
-	}
-	else { solvetime=T; } // the smarter choice
-	S[h] = S[h-1] + solvetime;
-	real_time[h] = real_time[h-1] + solvetime;
-	// Make targets initially perfect as close approximation.
-	targets[h] = pow(2,256)/public_HR/T; 
-	difficulty = powLimit/targets[h];
-	cout << h << ",\t" << S[h] << ",\t" << difficulty << ",\t" << targets[h] << ",\t" << real_time[h] 
-	<< ",\t" << S[h]-S[h-1] << endl; 
-   // cout << h << " " << S[h] << " " <<  round(1000*difficulty/avg_initial_diff)/1000 << " " << solvetime << endl;
-}
-
-if (test_DA == 1) { cout << "Begin testing difficulty calculations.\n"; }
-else { cout << "Begin attack.\n height, timestamp, MTP, normalized difficulty, " <<
-	"solvetime, real time, minutes into attack\n";
-}
-u min_adj = adjust;
-u max_adj = adjust;
-if (try_all_adjusts && !test_DA) { min_adj = 24; max_adj = 300; }
-
-for (u adjust = min_adj; adjust <= max_adj; adjust++) 
-{ 
-u h=0;
-u MTP_array[MTP];
-u MTP_next = 1; 
-u MTP_previous = 0;
-u j = 0;
-d sumTimeWeightedTarget=0; 
-d sumDiffs=0;
-d maxTimestamp=0;
-
-u M = L*N*T; // A useful constant
-// The following is the attacker's first timestamp. It is forward in time, but 
-// it becomes the "held-back" MTP that is the key to the attack's success
-u Q = S[N+MTP-N] + M*adjust/100; 
-for (h = N+MTP; h < blocks+N+MTP; h++ ) {
-	// Apply difficulty algorithm
-	targets[h] = run_DA(choose_DA, targets, S, N, T, L, h);
-	
-	// Get randomized solvetime for this target and HR to keep track of real time
-	solvetime = pow(2,256)/ targets[h] / public_HR * log( 1/fRand(0,1) )/attacker_HR ;
-	real_time[h] = round(real_time[h-1] + solvetime);
-
-	if (test_DA) {  // for testing DA without the attack
-		S[h] = solvetime + S[h-1];  
-		cout << h << ",\t" << S[h] << ",\t" << powLimit/targets[h] << ",\t" << targets[h] << ",\t" << S[h]-S[h-1] << endl;
-	}
-	else {
-		// Begin attacker code to determine best timestamp to assign.
-
-		// Attacker alternates timestamps to be Q and Q+M, but before using
-		// the 2nd (which lowers the difficulty), he has to make sure 
-		// MTP_previous + 1 <= MTP_next to not violate protocol and 
-		// MTP_next <= Q to keep the attack alive and well by retarding MTP.
-
-		// First N blocks can be done a certain way to maximize future gains.
-		if ( j==0 ) { S[h]= Q; } // begin attack 
-		else if ( j <= N ) {
-			// Calculate MTP of next block
-			MTP_array[0] = M+S[h-N];  // old: min(Q + M, M+S[h-N]);
-			for (u i = 1; i<MTP; i++) { MTP_array[i] = S[h-i]; }
-			MTP_next = median(MTP_array, MTP); 
-
-			// This is the key code for 1st N blocks.
-			if ( MTP_next <= Q && MTP_next >= MTP_previous &&
-				Q == S[h-1]+1 ) { S[h] =  M + S[h-N]; } // jumps to a forward time if MTP is safely delayed.
-			else { S[h] = Q; }  // holds back the MTP
-		}
-		// After 1st N blocks, do the sustained attack pattern.
-		// It's possible to use the following alone to replace the above, but 
-		// may take 2x longer in some algos. 
-		else  {
-			MTP_array[0] = Q + M;
-			for (u i = 1; i<MTP; i++) { MTP_array[i] = S[h-i]; }
-			MTP_next = median(MTP_array, MTP); 
-			
-			// This is the key code for the sustained attack.
-			if ( MTP_next <= Q && MTP_next >= MTP_previous && 
-					Q == S[h-N]+N )  {  S[h] = M + Q;  }  // jumps to our forward "submit" time if MTP is safely delayed.
-			else { S[h] = Q;  }  // holds back the MTP
-		}
-		Q += 1; // Because protocol requires timestamps >= MTP + 1 second 
-
-		for (u i = 1; i<=MTP; i++) { MTP_array[i] = S[h-i];  }
-		MTP_previous = median(MTP_array, MTP);
-	
-		difficulty = powLimit/targets[h];
-		sumDiffs += difficulty;
-		sumTimeWeightedTarget += targets[h]*solvetime; 
-		if (!try_all_adjusts) {
-			cout << h << "\t" << S[h] << "\t" << MTP_previous << "\t" 
-			<< round(1000*difficulty/avg_initial_diff)/1000 << "\t" << round(solvetime) 
-			<< "\t" << real_time[h] << "\t"<< round(10*(real_time[h] - real_time[MTP+N-1])/60)/10 
-			<< endl;
-		}
-
-		// Double check the code
-		for (u i = 0; i<MTP; i++) { MTP_array[i] = S[h-i];  }
-		MTP_next = median(MTP_array, MTP);
-
-		if (MTP_next < MTP_previous) { cout << "MTP_next (" << MTP_next << ") is smaller than " 
-		<< MTP_previous << ". Adjust setting was too small.\n"; break;}
-
-		if (S[h] > maxTimestamp) { maxTimestamp = S[h]; }
-		if ( maxTimestamp < real_time[h] && j > 1.5*N ) {
-			if (!try_all_adjusts) {
-				cout << "\nReal time has caught up with the forwarded timestamps.";
-				cout << "Send the private chain to public nodes or increase 'adjust' to ";
-				cout << "get more blocks in possibly a lot less time.\n";
-			}
-			break;
-		}
-	}
-	j++;
-} //  end loop based on height
-
-if (test_DA != 1 && !try_all_adjusts) { cout << "\nheight, timestamp, MTP, normalized Difficulty, " << 
-	"solvetime, real time, minutes into attack\n"; 
-}
-d tw_norm_diff = powLimit/avg_initial_diff*(real_time[j-1+N+MTP]-real_time[N+MTP-1])/sumTimeWeightedTarget;
-if (!try_all_adjusts) {
-	cout << "\nAvg solvetime: " << (real_time[j-1+N+MTP]-real_time[N+MTP-1])/j << " seconds\n"; 
-	cout << "Time-weighted normalized difficulty: " << tw_norm_diff <<	endl; 
-	cout << "Average normalized difficulty: " << sumDiffs/avg_initial_diff/j << endl;
-}
-else if (maxTimestamp < real_time[h-1]+2*T ){
-	cout << adjust << " " << j << " " << maxTimestamp-S[N+MTP-1] << " " << real_time[h-1]-S[N+MTP-1] << " " 
-	<< round(100*real_time[h-1]/3600)/100 << " " << tw_norm_diff << endl;
-}
-} // end trying each adjust
-if (try_all_adjusts) { 
-	cout << "adjust, blocks, max tamestamp, real time, attack hours, avg normalized difficulty\n";
-}
-return(0);
-}
+// Timespan Limit Attack Demonstration
+// Copyright (c) Zawy 2019
+// MIT License
+/*
+This demonstrates how a >50% selfish mining attack can get unlimited number of blocks in about 3x the 
+difficulty window by retarding the MTP and using timespan limits against themselves. The attack can work on 
+any algo that use a timespan limit without requiring the timestamps to be sequential. It currently only
+tests symmetrical limits on simple moving averages like BCH and DASH. A future update may include the 
+easier cases of fixed-window algos like BTC and LTC and asymmetrical fractional limits.
+See https://github.com/zawy12/difficulty-algorithms/issues/30
+*/
+
+#include <iostream>     // for cout
+#include <math.h>		
+#include <string>
+#include <cstdint>
+#include <bits/stdc++.h> // for array sort
+#include "uint256.h" // targets
+#include "phase_timing.h" // -DPHASE_TIMING for where the time goes
+using namespace std;
+typedef int64_t u;
+typedef double d; // for hashrates, times, and displaying difficulty. Targets are uint256.
+
+u draws = 0; // rand() calls so far, so a resumed run can get rand() back to the same place
+float fRand(float fMin, float fMax) {   
+		float f = (float)rand() / RAND_MAX;
+	draws++;
+    return fMin + f * (fMax - fMin);
+}
+u median(u a[], u n) { sort(a, a+n);   return a[n/2];  } 
+
+enum { PH_SETUP, PH_DA, PH_SOLVETIME, PH_ATTACK, PH_OUTPUT, PH_RESULTS, PH_CHECKPOINT, PHASES };
+const char* const PHASE_NAMES[PHASES] = {"setup", "DA", "solvetime", "attack", "output", "results", "checkpoint"};
+
+/* try_all_adjusts can take a long time, so it saves where it is to checkpoint_file every checkpoint_seconds, after 
+an adjust, by writing a .tmp and renaming it so a kill can't leave half of one. "./timespan_attack --resume" goes on 
+from it if the settings are the same: it reprints the adjusts that were done, makes the same first blocks from the 
+same seed, and calls rand() as many times as they did, so the rest is what it would have been if it wasn't stopped. */
+const char CHECKPOINT_MAGIC[8] = {'T','S','A','C','K','P','T','1'};
+bool save_checkpoint(const string& path, const string& settings, u seed, u next_adjust, const string& results) {
+	string tmp = path + ".tmp";
+	ofstream f(tmp, ios::binary);
+	u n[5] = {seed, draws, next_adjust, u(settings.size()), u(results.size())};
+	f.write(CHECKPOINT_MAGIC, 8); 
+	f.write((const char*)n, sizeof(n)); 
+	f << settings << results;
+	f.close();
+	return f && rename(tmp.c_str(), path.c_str()) == 0;
+}
+bool load_checkpoint(const string& path, const string& settings, u& seed, u& resume_draws, u& next_adjust, string& results) {
+	ifstream f(path, ios::binary);
+	char magic[8];
+	u n[5];
+	f.read(magic, 8);
+	f.read((char*)n, sizeof(n));
+	if (!f || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0 || n[3] != u(settings.size())) { return false; }
+	string saved(n[3], ' ');
+	results.assign(n[4], ' ');
+	f.read(&saved[0], n[3]);
+	f.read(&results[0], n[4]);
+	if (!f || saved != settings) { return false; }
+	seed = n[0]; resume_draws = n[1]; next_adjust = n[2];
+	return true;
+}
+
+/* The DAs are templates so --check can run the same code on doubles. Multiplying the sum of N targets by a timespan 
+overflows 2^256 once an attack has raised the targets a few times, so they use mul_div(). */
+// floor(a*m/div) = (a/div)*m + (a%div)*m/div, where (a%div)*m fits in 128 bits.
+uint256 mul_div(uint256 a, u m, u div) {
+	uint64_t r = a.divmod(div);
+	return a*m + uint64_t(uint128_t(r)*m/div);
+}
+d mul_div(d a, u m, u div) { return a*m/div; }
+
+template<class X> X BCH(X targets[], u S[], u N, u T, u L, u h) {
+	X sumTargets=0;
+	u front_array[3] = {S[h-1],   S[h-2],   S[h-3]};
+	u back_array[3]  = {S[h-1-N], S[h-2-N], S[h-3-N]};
+	// BCH reduces out of sequence timstamps like this:
+	u front = median( front_array, 3 );
+	u back = median( back_array, 3 );
+	// Here's the limit that allows the exploit.
+	u timespan = min(L*N*T, max(N*T/L, front - back));
+	
+	// Identify the corresponding targets
+	u j;
+	if	(front == S[h-1])	{ j = h-1; }
+	else if (front == S[h-2])	{ j = h-2; }
+	else				{ j = h-3; }
+	u k;
+	if	(back == S[h-1-N])	{ k = h-1-N; }
+	else if (back == S[h-2-N])	{ k = h-2-N; }
+	else				{ k = h-3-N; }
+	for (u i = j; i > k; i-- ) { sumTargets += targets[i]; }
+	return mul_div(sumTargets, timespan, T*(j-k)*(j-k)); 
+}
+template<class X> X SMA(X targets[], u S[], u N, u T, u L, u h) {
+	X sumTargets=0;
+	u timespan = min(L*N*T, max(N*T/L, S[h-1] - S[h-1-N]));
+	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
+	return mul_div(sumTargets, timespan, T*N*N); 
+}
+template<class X> X Digishield(X targets[], u S[], u N, u T, u L, u h) {
+	// This does not include the MTP delay in Digishield that stops the attack.
+	X sumTargets=0;
+	u timespan = min(L*N*T, max(N*T/L, S[h-1] - S[h-1-N]));
+	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
+	return mul_div(sumTargets, 3*N*T + timespan, T*N*N); 
+}
+template<class X> X DGW(X targets[], u S[], u N, u T, u L, u h) {
+	X sumTargets=0;
+	u timespan = min(L*N*T, max(N*T/L, S[h-1] - S[h-1-N]));
+	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
+ // The following makes DGW different from SMA: double weight to most recent target.
+	sumTargets +=targets[h-1];
+	return mul_div(sumTargets, timespan, T*N*(N+1));  
+}
+template<class X> X LWMA(X targets[], u S[], u N, u T, u L, u h) {
+	// not currently supported because the attack needs to be modified
+	X sumTargets=0;
+	u weighted_sum_time=0;
+	for (u i = h-1; i>=h-N; i--) { weighted_sum_time += min(6*T,max(-6*T,(S[i]-S[i-1]))); }
+	weighted_sum_time = max(u(1), weighted_sum_time);
+	for (u i = h-1; i>=h-N; i-- ) { sumTargets += targets[i]; }
+	return mul_div(sumTargets, weighted_sum_time*2, T*N*N*(N+1)); 
+}
+uint256 run_DA (string choose_DA, uint256 targets[], u S[], u N, u T, u L, u h) {
+	if (choose_DA == "BCH") { return BCH(targets, S, N, T, L, h); }
+	if (choose_DA == "SMA" ) { return SMA(targets, S, N, T, L, h); }
+	if (choose_DA == "DGW" ) { return DGW(targets, S, N, T, L, h); }
+/*	if (choose_DA == "Digishield" ) { Digishield(targets, S, N, T, L, h); }
+	if (choose_DA == "LWMA" ) { LWMA(targets, S, N, T, L, h); }
+	if (choose_DA == "Boris" ) { Boris(targets, S, N, T, L, h); }
+	if (choose_DA == "BTC" ) { BTC(targets, S, N, T, L, h); }
+	if (choose_DA == "LTC" ) { LTC(targets, S, N, T, L, h); }
+	if (choose_DA == "ETH" ) { ETH(targets, S, N, T, L, h); }   */
+	cout << choose_DA << " is not supported." << endl; exit(1);
+}
+// --check: every DA on the uint256 targets against the same DA on doubles. Returns how many differ by more than 1e-9.
+const char* const CHECK_NAMES[5] = {"BCH", "SMA", "Digishield", "DGW", "LWMA"};
+u check_DAs(uint256 targets[], vector<d>& dtargets, u S[], u N, u T, u L, u h) {
+	for (u i = h-N-3; i < h; i++) { dtargets[i] = targets[i].getdouble(); }
+	d* x = dtargets.data();
+	uint256 t[5] = { BCH(targets, S, N, T, L, h), SMA(targets, S, N, T, L, h), Digishield(targets, S, N, T, L, h),
+		DGW(targets, S, N, T, L, h), LWMA(targets, S, N, T, L, h) };
+	d r[5] = { BCH(x, S, N, T, L, h), SMA(x, S, N, T, L, h), Digishield(x, S, N, T, L, h), DGW(x, S, N, T, L, h), 
+		LWMA(x, S, N, T, L, h) };
+	u bad = 0;
+	for (int k = 0; k < 5; k++) {
+		if (fabs(t[k].getdouble()/r[k] - 1) < 1e-9) { continue; }
+		cout << CHECK_NAMES[k] << " at height " << h << ": " << t[k].getdouble() << " vs " << r[k] << " on doubles" << endl;
+		bad++;
+	}
+	return bad;
+}
+int main (int argc, char* argv[]) {
+bool resume = argc > 1 && string(argv[1]) == "--resume";
+// --check runs the attack and checks all 5 DAs' uint256 targets at every block against the same DA on doubles.
+bool check = argc > 1 && string(argv[1]) == "--check";
+u seed = time(0);
+
+u test_DA = 0; // set to 1 to test DA code without the attack
+
+u N = 20; // difficulty averaging window, use > MTP
+u L = 2; // timespan limit. BTC=4, BCH=2, DASH / DGW=3. Symmetrical assumed.
+u T = 100; // block time
+u MTP = 11; // most coins use MTP=11 (median of the past 11 timestamps)
+
+// The following is adjusted to increase the # of blocks gained and decrease the time required.
+// Select a target number of blocks (via blocks = 10*N below) then keep adjusting it.
+
+u adjust = 115;  // This is critical. A change of 1% can double the blocks. Typical range: 25 to 150.
+u try_all_adjusts = 0; // Set to 1 if you want it to try adjust settings 24 to 150.
+string checkpoint_file = "timespan_attack_checkpoint.bin"; // try_all_adjusts saves its progress here
+d checkpoint_seconds = 10;
+
+string choose_DA = "BCH"; // currently supports BCH, SMA, or DGW
+
+if (choose_DA == "BCH" ) { T=600; N=144; L=2; }  // BCH adjust = 103 got 70k blocks in 3.5 days; 
+if (choose_DA == "DGW" ) { N=24; L=3; }   // DGW.  Adjust = 25 got a lot
+
+u blocks = 1000; // How many blocks to get. (try = 3*N at first)
+
+u S[blocks + N + MTP]; // S = stamps = timestamps
+u real_time[blocks + N + MTP];
+d solvetime = 0; // for keeping track of real time
+vector<uint256> targets(blocks + N + MTP);
+uint256 max_target = ~uint256(0); // 2^256 - 1
+d public_HR = 100000; // Hashes per second
+d attacker_HR = 1; // attacker's HR as fraction of public_HR without him (1=50% attack, 2 = 66%) 
+d leading_zeros = 32; // 32 for BTC
+d powLimit = pow(2,256-leading_zeros);
+d difficulty; 
+d avg_initial_diff = public_HR*T/pow(2,leading_zeros);
+assert( MTP % 2 == 1); // allow only odd for easily finding median
+
+// h = height, S[] = timestamps
+
+PHASE_RESET();
+cout << "Initialize N + MTP blocks:\nheight,\ttimestamps,\tdifficulty,\ttarget,\treal time,\tsolvetime\n"; 
+
+// Initialize N+1 targets and timestamps before attack begins. 
+S[0]=0; // typically 0 or time(0)
+real_time[0] = S[0]; 
+targets[0]=max_target/u(public_HR)/T;
+u do_things_proper_which_makes_results_harder_to_understand = 0;
+// Everything that changes the results, for checking a checkpoint is from this run.
+string settings = choose_DA + " " + to_string(N) + " " + to_string(L) + " " + to_string(T) + " " + to_string(MTP) + 
+	" " + to_string(blocks) + " " + to_string(adjust) + " " + to_string(try_all_adjusts) + " " + to_string(test_DA) + 
+	" " + to_string(public_HR) + " " + to_string(attacker_HR) + " " + to_string(leading_zeros) + " " + 
+	to_string(do_things_proper_which_makes_results_harder_to_understand);
+u resume_draws = 0, resume_adjust = 0;
+string results; // the adjusts' lines so far
+if (resume) {
+	if (load_checkpoint(checkpoint_file, settings, seed, resume_draws, resume_adjust, results)) {
+		cout << "Resuming at adjust " << resume_adjust << " from " << checkpoint_file << endl;
+	}
+	else { cout << "No checkpoint for these settings in " << checkpoint_file << ", starting over." << endl; }
+}
+srand(seed);
+for (u h=1; h<N+MTP; h++) { 
+	if (do_things_proper_which_makes_results_harder_to_understand) {
+		solvetime = u(round(T*log( 1/fRand(0,1))));
+	}
+	else { solvetime=T; } // the smarter choice
+	S[h] = S[h-1] + solvetime;
+	real_time[h] = real_time[h-1] + solvetime;
+	// Make targets initially perfect as close approximation.
+	targets[h] = max_target/u(public_HR)/T; 
+	difficulty = powLimit/targets[h].getdouble();
+	cout << h << ",\t" << S[h] << ",\t" << difficulty << ",\t" << targets[h].getdouble() << ",\t" << real_time[h] 
+	<< ",\t" << S[h]-S[h-1] << endl; 
+   // cout << h << " " << S[h] << " " <<  round(1000*difficulty/avg_initial_diff)/1000 << " " << solvetime << endl;
+}
+
+if (test_DA == 1) { cout << "Begin testing difficulty calculations.\n"; }
+else { cout << "Begin attack.\n height, timestamp, MTP, normalized difficulty, " <<
+	"solvetime, real time, minutes into attack\n";
+}
+u min_adj = adjust;
+u max_adj = adjust;
+if (try_all_adjusts && !test_DA) { min_adj = 24; max_adj = 300; }
+bool checkpoints = try_all_adjusts && !test_DA;
+u checkpoints_written = 0;
+d checkpoint_time = 0;
+if (resume_adjust) { 
+	min_adj = resume_adjust; 
+	while (draws < resume_draws) { fRand(0,1); }
+	cout << results;
+}
+auto start = chrono::steady_clock::now(), last_checkpoint = start;
+vector<d> check_targets(check ? targets.size() : 0);
+u checked = 0, check_errors = 0;
+PHASE(PH_SETUP);
+
+for (u adjust = min_adj; adjust <= max_adj; adjust++) 
+{ 
+u h=0;
+u MTP_array[MTP];
+u MTP_next = 1; 
+u MTP_previous = 0;
+u j = 0;
+d sumTimeWeightedTarget=0; 
+d sumDiffs=0;
+d maxTimestamp=0;
+
+u M = L*N*T; // A useful constant
+// The following is the attacker's first timestamp. It is forward in time, but 
+// it becomes the "held-back" MTP that is the key to the attack's success
+u Q = S[N+MTP-N] + M*adjust/100; 
+for (h = N+MTP; h < blocks+N+MTP; h++ ) {
+	PHASE_SAMPLE(h);
+	// Apply difficulty algorithm
+	targets[h] = run_DA(choose_DA, targets.data(), S, N, T, L, h);
+	if (check) { check_errors += check_DAs(targets.data(), check_targets, S, N, T, L, h); checked++; }
+	PHASE(PH_DA);
+	
+	// Get randomized solvetime for this target and HR to keep track of real time
+	solvetime = pow(2,256)/ targets[h].getdouble() / public_HR * log( 1/fRand(0,1) )/attacker_HR ;
+	real_time[h] = round(real_time[h-1] + solvetime);
+	PHASE(PH_SOLVETIME);
+
+	if (test_DA) {  // for testing DA without the attack
+		S[h] = solvetime + S[h-1];  
+		cout << h << ",\t" << S[h] << ",\t" << powLimit/targets[h].getdouble() << ",\t" << targets[h].getdouble() << ",\t" << S[h]-S[h-1] << endl;
+		PHASE(PH_OUTPUT);
+	}
+	else {
+		// Begin attacker code to determine best timestamp to assign.
+
+		// Attacker alternates timestamps to be Q and Q+M, but before using
+		// the 2nd (which lowers the difficulty), he has to make sure 
+		// MTP_previous + 1 <= MTP_next to not violate protocol and 
+		// MTP_next <= Q to keep the attack alive and well by retarding MTP.
+
+		// First N blocks can be done a certain way to maximize future gains.
+		if ( j==0 ) { S[h]= Q; } // begin attack 
+		else if ( j <= N ) {
+			// Calculate MTP of next block
+			MTP_array[0] = M+S[h-N];  // old: min(Q + M, M+S[h-N]);
+			for (u i = 1; i<MTP; i++) { MTP_array[i] = S[h-i]; }
+			MTP_next = median(MTP_array, MTP); 
+
+			// This is the key code for 1st N blocks.
+			if ( MTP_next <= Q && MTP_next >= MTP_previous &&
+				Q == S[h-1]+1 ) { S[h] =  M + S[h-N]; } // jumps to a forward time if MTP is safely delayed.
+			else { S[h] = Q; }  // holds back the MTP
+		}
+		// After 1st N blocks, do the sustained attack pattern.
+		// It's possible to use the following alone to replace the above, but 
+		// may take 2x longer in some algos. 
+		else  {
+			MTP_array[0] = Q + M;
+			for (u i = 1; i<MTP; i++) { MTP_array[i] = S[h-i]; }
+			MTP_next = median(MTP_array, MTP); 
+			
+			// This is the key code for the sustained attack.
+			if ( MTP_next <= Q && MTP_next >= MTP_previous && 
+					Q == S[h-N]+N )  {  S[h] = M + Q;  }  // jumps to our forward "submit" time if MTP is safely delayed.
+			else { S[h] = Q;  }  // holds back the MTP
+		}
+		Q += 1; // Because protocol requires timestamps >= MTP + 1 second 
+
+		for (u i = 1; i<=MTP; i++) { MTP_array[i] = S[h-i];  }
+		MTP_previous = median(MTP_array, MTP);
+	
+		difficulty = powLimit/targets[h].getdouble();
+		sumDiffs += difficulty;
+		sumTimeWeightedTarget += targets[h].getdouble()*solvetime; 
+		PHASE(PH_ATTACK);
+		if (!try_all_adjusts) {
+			cout << h << "\t" << S[h] << "\t" << MTP_previous << "\t" 
+			<< round(1000*difficulty/avg_initial_diff)/1000 << "\t" << round(solvetime) 
+			<< "\t" << real_time[h] << "\t"<< round(10*(real_time[h] - real_time[MTP+N-1])/60)/10 
+			<< endl;
+			PHASE(PH_OUTPUT);
+		}
+
+		// Double check the code
+		for (u i = 0; i<MTP; i++) { MTP_array[i] = S[h-i];  }
+		MTP_next = median(MTP_array, MTP);
+
+		if (MTP_next < MTP_previous) { cout << "MTP_next (" << MTP_next << ") is smaller than " 
+		<< MTP_previous << ". Adjust setting was too small.\n"; break;}
+
+		if (S[h] > maxTimestamp) { maxTimestamp = S[h]; }
+		if ( maxTimestamp < real_time[h] && j > 1.5*N ) {
+			if (!try_all_adjusts) {
+				cout << "\nReal time has caught up with the forwarded timestamps.";
+				cout << "Send the private chain to public nodes or increase 'adjust' to ";
+				cout << "get more blocks in possibly a lot less time.\n";
+			}
+			break;
+		}
+		PHASE(PH_ATTACK);
+	}
+	j++;
+} //  end loop based on height
+PHASE_ALL();
+
+if (test_DA != 1 && !try_all_adjusts) { cout << "\nheight, timestamp, MTP, normalized Difficulty, " << 
+	"solvetime, real time, minutes into attack\n"; 
+}
+d tw_norm_diff = powLimit/avg_initial_diff*(real_time[j-1+N+MTP]-real_time[N+MTP-1])/sumTimeWeightedTarget;
+if (!try_all_adjusts) {
+	cout << "\nAvg solvetime: " << (real_time[j-1+N+MTP]-real_time[N+MTP-1])/j << " seconds\n"; 
+	cout << "Time-weighted normalized difficulty: " << tw_norm_diff <<	endl; 
+	cout << "Average normalized difficulty: " << sumDiffs/avg_initial_diff/j << endl;
+}
+else if (maxTimestamp < real_time[h-1]+2*T ){
+	ostringstream line;
+	line << adjust << " " << j << " " << maxTimestamp-S[N+MTP-1] << " " << real_time[h-1]-S[N+MTP-1] << " " 
+	<< round(100*real_time[h-1]/3600)/100 << " " << tw_norm_diff << endl;
+	cout << line.str();
+	results += line.str();
+}
+PHASE(PH_RESULTS);
+auto now = chrono::steady_clock::now();
+if (checkpoints && adjust < max_adj && chrono::duration<d>(now - last_checkpoint).count() >= checkpoint_seconds) {
+	if (save_checkpoint(checkpoint_file, settings, seed, adjust+1, results)) { checkpoints_written++; }
+	else { cout << "Can't write " << checkpoint_file << endl; }
+	PHASE_BYTES(PH_CHECKPOINT, 8 + 5*sizeof(u) + settings.size() + results.size());
+	PHASE(PH_CHECKPOINT);
+	last_checkpoint = chrono::steady_clock::now();
+	checkpoint_time += chrono::duration<d>(last_checkpoint - now).count();
+}
+} // end trying each adjust
+if (try_all_adjusts) { 
+	cout << "adjust, blocks, max tamestamp, real time, attack hours, avg normalized difficulty\n";
+	d run_time = chrono::duration<d>(chrono::steady_clock::now() - start).count();
+	cout << checkpoints_written << " checkpoints took " << 1000*checkpoint_time << " ms, " << 
+		100*checkpoint_time/run_time << "% of the run.\n";
+}
+PHASE(PH_RESULTS);
+PHASE_REPORT(cout, PHASE_NAMES, PHASES, false);
+if (check) { 
+	cout << checked << " blocks of the attack, " << check_errors << " DA targets differ from doubles by more than 1e-9." << endl; 
+	return check_errors > 0;
+}
+return(0);
+}
@@ -0,0 +1,209 @@
+// Header-only 256-bit unsigned integer for target math
+// Copyright (c) Zawy 2019, MIT License
+/*
+Targets don't fit in 64 bits, so the tools in this repo used doubles (timespan_attack.cpp) or
+difficulties instead of targets (test_DAs.cpp). This is a drop-in for what difficulty algorithms
+need from arith_uint256: add, sub, multiply and divide by a 64-bit integer, full multiply and divide,
+compare, and bits(). It uses 4 little-endian 64-bit limbs with unsigned __int128 for the carries and
+partial products, __builtin_clzll for bits() and normalizing, and Knuth's algorithm D for the full
+divide, so it needs gcc or clang. arith_uint256.h has the slow 32-bit-limb version that bitcoin uses.
+uint256_bench.cpp checks the two give the same answers and times them.
+Like arith_uint256, everything wraps mod 2^256 and dividing by zero gives zero.
+*/
+#ifndef UINT256_H
+#define UINT256_H
+
+#include <cstdint>
+#include <string>
+#include <math.h>
+
+typedef unsigned __int128 uint128_t;
+
+class uint256 {
+public:
+	uint64_t pn[4];
+
+	uint256(uint64_t b = 0) { pn[0] = b; pn[1] = pn[2] = pn[3] = 0; }
+
+	uint256 operator~() const { uint256 r; for (int i = 0; i < 4; i++) { r.pn[i] = ~pn[i]; } return r; }
+	uint256 operator-() const { uint256 r = ~(*this); r += 1; return r; }
+
+	uint256& operator+=(const uint256& b) {
+		uint128_t carry = 0;
+		for (int i = 0; i < 4; i++) {
+			carry += (uint128_t)pn[i] + b.pn[i];
+			pn[i] = (uint64_t)carry;
+			carry >>= 64;
+		}
+		return *this;
+	}
+	uint256& operator-=(const uint256& b) {
+		uint64_t borrow = 0;
+		for (int i = 0; i < 4; i++) {
+			uint128_t t = (uint128_t)pn[i] - b.pn[i] - borrow;
+			pn[i] = (uint64_t)t;
+			borrow = (uint64_t)(t >> 64) & 1;
+		}
+		return *this;
+	}
+	uint256& operator*=(uint64_t b) {
+		uint128_t carry = 0;
+		for (int i = 0; i < 4; i++) {
+			carry += (uint128_t)pn[i] * b;
+			pn[i] = (uint64_t)carry;
+			carry >>= 64;
+		}
+		return *this;
+	}
+	uint256& operator*=(const uint256& b) {
+		uint64_t r[4] = {0, 0, 0, 0};
+		for (int i = 0; i < 4; i++) {
+			if (pn[i] == 0) { continue; }
+			uint128_t carry = 0;
+			for (int j = 0; i + j < 4; j++) {
+				carry += (uint128_t)pn[i] * b.pn[j] + r[i+j];
+				r[i+j] = (uint64_t)carry;
+				carry >>= 64;
+			}
+		}
+		for (int i = 0; i < 4; i++) { pn[i] = r[i]; }
+		return *this;
+	}
+	// Divide by a 64-bit number and return the remainder.
+	uint64_t divmod(uint64_t d) {
+		if (d == 0) { *this = 0; return 0; }
+		uint64_t rem = 0;
+		for (int i = 3; i >= 0; i--) {
+			if (rem == 0 && pn[i] < d) { rem = pn[i]; pn[i] = 0; continue; }
+			uint128_t cur = ((uint128_t)rem << 64) | pn[i];
+			pn[i] = (uint64_t)(cur / d);
+			rem = (uint64_t)(cur % d);
+		}
+		return rem;
+	}
+	uint256& operator/=(uint64_t d) { divmod(d); return *this; }
+	uint256& operator/=(const uint256& b) {
+		int n = b.limbs();
+		if (n <= 1) { divmod(b.pn[0]); return *this; }
+		if (*this < b) { *this = 0; return *this; }
+		// Knuth algorithm D with 2^64 digits. Normalize so the divisor's top bit is set.
+		int s = __builtin_clzll(b.pn[n-1]);
+		uint64_t vn[4], un[5];
+		for (int i = n-1; i > 0; i--) { vn[i] = (b.pn[i] << s) | (s ? b.pn[i-1] >> (64-s) : 0); }
+		vn[0] = b.pn[0] << s;
+		un[4] = s ? pn[3] >> (64-s) : 0;
+		for (int i = 3; i > 0; i--) { un[i] = (pn[i] << s) | (s ? pn[i-1] >> (64-s) : 0); }
+		un[0] = pn[0] << s;
+		uint64_t q[4] = {0, 0, 0, 0};
+		for (int j = 4-n; j >= 0; j--) {
+			uint128_t num = ((uint128_t)un[j+n] << 64) | un[j+n-1];
+			uint128_t qhat = num / vn[n-1];
+			uint128_t rhat = num % vn[n-1];
+			while ((qhat >> 64) || qhat*vn[n-2] > ((rhat << 64) | un[j+n-2])) {
+				qhat--;
+				rhat += vn[n-1];
+				if (rhat >> 64) { break; }
+			}
+			// Multiply and subtract.
+			__int128 k = 0, t;
+			for (int i = 0; i < n; i++) {
+				uint128_t p = qhat*vn[i];
+				t = (__int128)un[i+j] - k - (__int128)(uint64_t)p;
+				un[i+j] = (uint64_t)t;
+				k = (__int128)(uint64_t)(p >> 64) - (t >> 64);
+			}
+			t = (__int128)un[j+n] - k;
+			un[j+n] = (uint64_t)t;
+			q[j] = (uint64_t)qhat;
+			if (t < 0) { // Subtracted too much, add back.
+				q[j]--;
+				uint128_t c = 0;
+				for (int i = 0; i < n; i++) {
+					c += (uint128_t)un[i+j] + vn[i];
+					un[i+j] = (uint64_t)c;
+					c >>= 64;
+				}
+				un[j+n] += (uint64_t)c;
+			}
+		}
+		for (int i = 0; i < 4; i++) { pn[i] = q[i]; }
+		return *this;
+	}
+	uint256& operator<<=(unsigned int shift) {
+		if (shift >= 256) { *this = 0; return *this; }
+		int k = shift / 64; shift %= 64;
+		for (int i = 3; i >= 0; i--) {
+			uint64_t hi = i-k >= 0 ? pn[i-k] << shift : 0;
+			uint64_t lo = (shift && i-k-1 >= 0) ? pn[i-k-1] >> (64-shift) : 0;
+			pn[i] = hi | lo;
+		}
+		return *this;
+	}
+	uint256& operator>>=(unsigned int shift) {
+		if (shift >= 256) { *this = 0; return *this; }
+		int k = shift / 64; shift %= 64;
+		for (int i = 0; i < 4; i++) {
+			uint64_t lo = i+k < 4 ? pn[i+k] >> shift : 0;
+			uint64_t hi = (shift && i+k+1 < 4) ? pn[i+k+1] << (64-shift) : 0;
+			pn[i] = hi | lo;
+		}
+		return *this;
+	}
+	int compare(const uint256& b) const {
+		for (int i = 3; i >= 0; i--) {
+			if (pn[i] != b.pn[i]) { return pn[i] < b.pn[i] ? -1 : 1; }
+		}
+		return 0;
+	}
+	int limbs() const {
+		for (int i = 3; i >= 0; i--) { if (pn[i]) { return i+1; } }
+		return 0;
+	}
+	unsigned int bits() const {
+		for (int i = 3; i >= 0; i--) { if (pn[i]) { return 64*i + 64 - __builtin_clzll(pn[i]); } }
+		return 0;
+	}
+	double getdouble() const {
+		return ldexp((double)pn[3], 192) + ldexp((double)pn[2], 128) + ldexp((double)pn[1], 64) + (double)pn[0];
+	}
+	uint64_t GetLow64() const { return pn[0]; }
+	// nBits. Same as arith_uint256::SetCompact / GetCompact without the sign and overflow flags.
+	uint256& SetCompact(uint32_t nCompact) {
+		int nSize = nCompact >> 24;
+		uint32_t nWord = nCompact & 0x007fffff;
+		if (nSize <= 3) { *this = nWord >> 8*(3-nSize); }
+		else { *this = nWord; *this <<= 8*(nSize-3); }
+		return *this;
+	}
+	uint32_t GetCompact() const {
+		int nSize = (bits() + 7)/8;
+		uint32_t nCompact = nSize <= 3 ? uint32_t(pn[0] << 8*(3-nSize)) : uint32_t((*this >> 8*(nSize-3)).pn[0]);
+		if (nCompact & 0x00800000) { nCompact >>= 8; nSize++; }
+		return nCompact | (nSize << 24);
+	}
+	std::string GetHex() const {
+		static const char hexdigits[] = "0123456789abcdef";
+		std::string s;
+		for (int i = 3; i >= 0; i--) {
+			for (int n = 60; n >= 0; n -= 4) { s += hexdigits[(pn[i] >> n) & 15]; }
+		}
+		return s;
+	}
+
+	friend uint256 operator+(uint256 a, const uint256& b) { return a += b; }
+	friend uint256 operator-(uint256 a, const uint256& b) { return a -= b; }
+	friend uint256 operator*(uint256 a, uint64_t b) { return a *= b; }
+	friend uint256 operator*(uint256 a, const uint256& b) { return a *= b; }
+	friend uint256 operator/(uint256 a, uint64_t b) { return a /= b; }
+	friend uint256 operator/(uint256 a, const uint256& b) { return a /= b; }
+	friend uint256 operator<<(uint256 a, unsigned int s) { return a <<= s; }
+	friend uint256 operator>>(uint256 a, unsigned int s) { return a >>= s; }
+	friend bool operator<(const uint256& a, const uint256& b) { return a.compare(b) < 0; }
+	friend bool operator>(const uint256& a, const uint256& b) { return a.compare(b) > 0; }
+	friend bool operator<=(const uint256& a, const uint256& b) { return a.compare(b) <= 0; }
+	friend bool operator>=(const uint256& a, const uint256& b) { return a.compare(b) >= 0; }
+	friend bool operator==(const uint256& a, const uint256& b) { return a.compare(b) == 0; }
+	friend bool operator!=(const uint256& a, const uint256& b) { return a.compare(b) != 0; }
+};
+
+#endif
@@ -0,0 +1,93 @@
+// uint256 check and benchmark
+// Copyright (c) Zawy 2019, MIT License
+/*
+Checks uint256.h against the naive 32-bit limb arith_uint256.h (which does what bitcoin does) on
+random numbers of random sizes, then times each operation a difficulty algorithm uses. I compile
+and run this with:
+g++ -std=c++11 -O2 uint256_bench.cpp -o uint256_bench && ./uint256_bench
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include "uint256.h"
+#include "arith_uint256.h"
+using namespace std;
+typedef uint64_t u;
+
+mt19937_64 rng(12345);
+
+// Random number with a random number of bits so divides hit every path.
+uint256 random_uint256() {
+	uint256 a;
+	for (int i = 0; i < 4; i++) { a.pn[i] = rng(); }
+	return a >> (rng() % 256);
+}
+arith_uint256 to_arith(const uint256& a) {
+	arith_uint256 b;
+	for (int i = 0; i < 4; i++) { b.pn[2*i] = uint32_t(a.pn[i]); b.pn[2*i+1] = uint32_t(a.pn[i] >> 32); }
+	return b;
+}
+u random_u64() { u d = rng() >> (rng() % 64); return d ? d : 1; }
+
+// Time f() over all n operands and return ns per op. sink keeps the compiler from removing the work.
+u sink = 0;
+template <typename F> double ns_per_op(F f, u n) {
+	auto start = chrono::steady_clock::now();
+	for (u i = 0; i < n; i++) { sink += f(i); }
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count()/n;
+}
+
+int main() {
+u n = 200000, errors = 0;
+vector<uint256> a(n), b(n);
+vector<arith_uint256> A(n), B(n);
+vector<u> d(n);
+for (u i = 0; i < n; i++) {
+	a[i] = random_uint256(); b[i] = random_uint256(); d[i] = random_u64();
+	if (b[i] == 0) { b[i] = 1; }
+	A[i] = to_arith(a[i]); B[i] = to_arith(b[i]);
+}
+
+// Check
+for (u i = 0; i < n; i++) {
+	string x[8] = { (a[i]+b[i]).GetHex(), (a[i]-b[i]).GetHex(), (a[i]*d[i]).GetHex(), (a[i]/d[i]).GetHex(),
+		(a[i]*b[i]).GetHex(), (a[i]/b[i]).GetHex(), to_string(a[i] < b[i]), to_string(a[i].bits()) };
+	string y[8] = { (A[i]+B[i]).GetHex(), (A[i]-B[i]).GetHex(), (A[i]*d[i]).GetHex(), (A[i]/d[i]).GetHex(),
+		(A[i]*B[i]).GetHex(), (A[i]/B[i]).GetHex(), to_string(A[i] < B[i]), to_string(A[i].bits()) };
+	for (int k = 0; k < 8; k++) {
+		if (x[k] != y[k]) {
+			if (errors < 10) { cout << "op " << k << " differs for " << a[i].GetHex() << " " << b[i].GetHex() << " " << d[i] << endl; }
+			errors++;
+		}
+	}
+}
+cout << 8*n << " results checked against arith_uint256, " << errors << " differ." << endl;
+
+cout << "op\tuint256 ns\tarith_uint256 ns\tspeedup" << endl;
+string names[8] = {"add", "sub", "mul64", "div64", "mul", "div", "compare", "bits"};
+double fast[8], naive[8];
+fast[0] = ns_per_op([&](u i) { return (a[i]+b[i]).pn[0]; }, n);
+naive[0] = ns_per_op([&](u i) { return (A[i]+B[i]).pn[0]; }, n);
+fast[1] = ns_per_op([&](u i) { return (a[i]-b[i]).pn[0]; }, n);
+naive[1] = ns_per_op([&](u i) { return (A[i]-B[i]).pn[0]; }, n);
+fast[2] = ns_per_op([&](u i) { return (a[i]*d[i]).pn[0]; }, n);
+naive[2] = ns_per_op([&](u i) { return (A[i]*d[i]).pn[0]; }, n);
+fast[3] = ns_per_op([&](u i) { return (a[i]/d[i]).pn[0]; }, n);
+naive[3] = ns_per_op([&](u i) { return (A[i]/d[i]).pn[0]; }, n);
+fast[4] = ns_per_op([&](u i) { return (a[i]*b[i]).pn[0]; }, n);
+naive[4] = ns_per_op([&](u i) { return (A[i]*B[i]).pn[0]; }, n);
+fast[5] = ns_per_op([&](u i) { return (a[i]/b[i]).pn[0]; }, n);
+naive[5] = ns_per_op([&](u i) { return (A[i]/B[i]).pn[0]; }, n);
+fast[6] = ns_per_op([&](u i) { return u(a[i] < b[i]); }, n);
+naive[6] = ns_per_op([&](u i) { return u(A[i] < B[i]); }, n);
+fast[7] = ns_per_op([&](u i) { return u(a[i].bits()); }, n);
+naive[7] = ns_per_op([&](u i) { return u(A[i].bits()); }, n);
+for (int k = 0; k < 8; k++) {
+	cout << names[k] << "\t" << fast[k] << "\t\t" << naive[k] << "\t\t" << naive[k]/fast[k] << endl;
+}
+if (sink == 1) { cout << endl; }
+return(errors > 0);
+}